@@ -37,10 +37,20 @@ target_sources(RNBOApp
   src/MainComponent.cpp
   src/CustomAudioEditor.cpp
   src/CustomAudioProcessor.cpp
+  src/state/StateFormat.cpp
+  src/state/StateCache.cpp
+  src/state/PresetSwitcher.cpp
+  src/state/PresetBank.cpp
+  src/messaging/MessageRouter.cpp
+  src/messaging/TransportFeed.cpp
+  src/messaging/CommandBus.cpp
   src/Components/SequencerComponent.cpp
   src/Components/SliderMasked.cpp
   src/Components/SliderRotary.cpp
+  src/Components/RotaryFilmstrips.cpp
   src/Components/PresetBar/PresetBar.cpp
+  src/Components/PresetBar/PresetIndex.cpp
+  src/Components/PresetBar/PresetPrefetcher.cpp
   src/Components/LookAndFeel/ChippoLookAndFeel.cpp
   src/Components/EditorContainer/EditorContainer.cpp
 
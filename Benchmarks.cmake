@@ -0,0 +1,34 @@
+# Microbenchmarks for the nlt utilities. They only need juce_core and juce_events, not the RNBO export.
+#
+#   InstanceManagerBenchmark [--instances 10000] [--rounds 5]
+
+juce_add_console_app(InstanceManagerBenchmark
+  COMPANY_NAME "Emily Hopkins"
+  PRODUCT_NAME "InstanceManagerBenchmark")
+
+juce_generate_juce_header(InstanceManagerBenchmark)
+
+target_sources(InstanceManagerBenchmark
+  PRIVATE
+  src/benchmarks/InstanceManagerBenchmark.cpp
+  )
+
+target_include_directories(InstanceManagerBenchmark
+  PRIVATE
+  "${CMAKE_CURRENT_SOURCE_DIR}/src/utilities"
+  )
+
+target_compile_definitions(InstanceManagerBenchmark
+  PRIVATE
+  JUCE_WEB_BROWSER=0
+  JUCE_USE_CURL=0)
+
+target_link_libraries(InstanceManagerBenchmark
+  PRIVATE
+  juce::juce_core
+  juce::juce_events
+  PUBLIC
+  juce::juce_recommended_config_flags
+  juce::juce_recommended_lto_flags
+  juce::juce_recommended_warning_flags
+  )
@@ -56,11 +56,21 @@ target_sources(RNBOAudioPlugin PRIVATE
   src/Plugin.cpp
   src/CustomAudioEditor.cpp
   src/CustomAudioProcessor.cpp
+  src/state/StateFormat.cpp
+  src/state/StateCache.cpp
+  src/state/PresetSwitcher.cpp
+  src/state/PresetBank.cpp
+  src/messaging/MessageRouter.cpp
+  src/messaging/TransportFeed.cpp
+  src/messaging/CommandBus.cpp
   src/Components/SequencerComponent.cpp
   src/Components/SliderMasked.cpp
   src/Components/SliderRotary.cpp
+  src/Components/RotaryFilmstrips.cpp
   src/Components/EditorContainer/EditorContainer.cpp
   src/Components/PresetBar/PresetBar.cpp
+  src/Components/PresetBar/PresetIndex.cpp
+  src/Components/PresetBar/PresetPrefetcher.cpp
   src/Components/LookAndFeel/ChippoLookAndFeel.cpp
   ${CPP_SOURCES}
 #  PUBLIC
@@ -0,0 +1,90 @@
+# `juce_add_console_app` adds a headless executable target. RNBORender builds the same processor as the
+# plugin and the app, but never creates an editor or opens an audio device, so presets can be rendered to
+# disk as fast as the CPU allows.
+#
+#   ChippoRender --preset <file.hop> --out <file.wav> [--bars 4] [--bpm 120] [--sr 48000] [--block 512] [--seed 0]
+#   ChippoRender --presets <folder> --out <folder> [--jobs <num cpus>] ...   renders a whole preset tree in parallel
+
+juce_add_console_app(RNBORender
+  COMPANY_NAME "Emily Hopkins"
+  PRODUCT_NAME "ChippoRender")
+
+# the RNBO adapters currently need this
+juce_generate_juce_header(RNBORender)
+
+# the processor's sources pull in the editor headers, so the render target builds the same set of files as
+# the app, minus the window and device code
+target_sources(RNBORender
+  PRIVATE
+  src/Render.cpp
+  src/offline/OfflineRenderer.cpp
+  src/offline/BatchRenderer.cpp
+  src/CustomAudioEditor.cpp
+  src/CustomAudioProcessor.cpp
+  src/state/StateFormat.cpp
+  src/state/StateCache.cpp
+  src/state/PresetSwitcher.cpp
+  src/state/PresetBank.cpp
+  src/messaging/MessageRouter.cpp
+  src/messaging/TransportFeed.cpp
+  src/messaging/CommandBus.cpp
+  src/Components/SequencerComponent.cpp
+  src/Components/SliderMasked.cpp
+  src/Components/SliderRotary.cpp
+  src/Components/RotaryFilmstrips.cpp
+  src/Components/PresetBar/PresetBar.cpp
+  src/Components/PresetBar/PresetIndex.cpp
+  src/Components/PresetBar/PresetPrefetcher.cpp
+  src/Components/LookAndFeel/ChippoLookAndFeel.cpp
+  src/Components/EditorContainer/EditorContainer.cpp
+
+  ${RNBO_CLASS_FILE}
+
+  ${RNBO_CPP_DIR}/RNBO.cpp
+  ${RNBO_CPP_DIR}/adapters/juce/RNBO_JuceAudioProcessorUtils.cpp
+  ${RNBO_CPP_DIR}/adapters/juce/RNBO_JuceAudioProcessorEditor.cpp
+  ${RNBO_CPP_DIR}/adapters/juce/RNBO_JuceAudioProcessor.cpp
+  )
+
+if (EXISTS ${RNBO_BINARY_DATA_FILE})
+  target_sources(RNBORender PRIVATE ${RNBO_BINARY_DATA_FILE})
+endif()
+
+target_include_directories(RNBORender
+  PRIVATE
+  ${RNBO_CPP_DIR}/
+  ${RNBO_CPP_DIR}/src
+  ${RNBO_CPP_DIR}/common/
+  ${RNBO_CPP_DIR}/adapters/juce/
+  ${RNBO_CPP_DIR}/src/3rdparty/
+  "${CMAKE_CURRENT_SOURCE_DIR}/src/utilities"
+  "${CMAKE_CURRENT_SOURCE_DIR}/src/utilities/change-listeners"
+  "${CMAKE_CURRENT_SOURCE_DIR}/src/utilities/multithreading"
+  "${CMAKE_CURRENT_SOURCE_DIR}/src/utilities/instance-management"
+  "${CMAKE_CURRENT_SOURCE_DIR}/src/utilities/containers"
+  "${CMAKE_CURRENT_SOURCE_DIR}/src/parameter-handling"
+  "${CMAKE_CURRENT_SOURCE_DIR}/src/parameter-handling/attachments"
+  src
+)
+
+target_compile_definitions(RNBORender
+  PRIVATE
+  JUCE_WEB_BROWSER=0
+  JUCE_USE_CURL=0
+  JUCE_APPLICATION_NAME_STRING="$<TARGET_PROPERTY:RNBORender,JUCE_PRODUCT_NAME>"
+  JUCE_APPLICATION_VERSION_STRING="$<TARGET_PROPERTY:RNBORender,JUCE_VERSION>")
+
+target_link_libraries(RNBORender
+  PRIVATE
+  $<TARGET_NAME_IF_EXISTS:HopkinsBinaryData>
+  juce::juce_gui_extra
+  juce::juce_audio_basics
+  juce::juce_audio_formats
+  juce::juce_audio_processors
+  juce::juce_audio_utils
+  juce::juce_data_structures
+  PUBLIC
+  juce::juce_recommended_config_flags
+  juce::juce_recommended_lto_flags
+  juce::juce_recommended_warning_flags
+  )
@@ -0,0 +1,61 @@
+# Writes chippo_parameter_table.h into OUTPUT_DIR from the RNBO export's description.json.
+#
+# The header holds a constexpr table of every parameter's id and RNBO index, so the plugin can find its
+# parameters by index instead of matching strings at runtime. Which processor parameter is which is worked
+# out from the RNBO index when the processor starts, see src/components/ParameterTable.h. Ranges aren't
+# written, the processor's parameters already have them from the adapter.
+#
+# Needs CMake 3.19 for string(JSON). On older versions, or without a description, nothing is written
+# and the code falls back to looking things up at runtime. Entries without a string id or a numeric
+# index (RNBO writes null for some fields) are left out.
+
+function(chippo_write_parameter_table_if_exists DESCRIPTION_FILE OUTPUT_DIR)
+    set(OUTPUT_FILE "${OUTPUT_DIR}/chippo_parameter_table.h")
+
+    if (NOT EXISTS ${DESCRIPTION_FILE} OR CMAKE_VERSION VERSION_LESS 3.19)
+        file(REMOVE ${OUTPUT_FILE})
+        return()
+    endif ()
+
+    # rerun when the export changes
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${DESCRIPTION_FILE})
+
+    file(READ ${DESCRIPTION_FILE} DESCRIPTION)
+
+    set(INFOS "")
+    set(NUM_INFOS 0)
+    string(JSON NUM_PARAMETERS ERROR_VARIABLE NO_PARAMETERS LENGTH "${DESCRIPTION}" parameters)
+    if (NOT NO_PARAMETERS AND NUM_PARAMETERS GREATER 0)
+        math(EXPR LAST "${NUM_PARAMETERS} - 1")
+        foreach (I RANGE ${LAST})
+            string(JSON ID_TYPE ERROR_VARIABLE NO_ID TYPE "${DESCRIPTION}" parameters ${I} paramId)
+            string(JSON INDEX_TYPE ERROR_VARIABLE NO_INDEX TYPE "${DESCRIPTION}" parameters ${I} index)
+            if (NO_ID OR NO_INDEX OR NOT ID_TYPE STREQUAL "STRING" OR NOT INDEX_TYPE STREQUAL "NUMBER")
+                continue()
+            endif ()
+
+            string(JSON ID GET "${DESCRIPTION}" parameters ${I} paramId)
+            string(JSON INDEX GET "${DESCRIPTION}" parameters ${I} index)
+
+            string(APPEND INFOS "    { \"${ID}\", ${INDEX} },\n")
+            math(EXPR NUM_INFOS "${NUM_INFOS} + 1")
+        endforeach ()
+    endif ()
+
+    set(CONTENT "// generated from ${DESCRIPTION_FILE} by cmake/ChippoParameterTable.cmake, don't edit\n\n")
+    string(APPEND CONTENT "#pragma once\n\n#define CHIPPO_HAS_PARAMETER_TABLE 1\n\n")
+    string(APPEND CONTENT "namespace ChippoParameterTable\n{\n\n")
+    string(APPEND CONTENT "struct Info\n{\n    const char* id;\n    int         rnboIndex;\n};\n\n")
+    string(APPEND CONTENT "static constexpr int numParameters = ${NUM_INFOS};\n\n")
+    if (NUM_INFOS GREATER 0)
+        string(APPEND CONTENT "static constexpr Info parameters[] = {\n${INFOS}};\n\n")
+    else ()
+        string(APPEND CONTENT "static constexpr Info* parameters = nullptr;\n\n")
+    endif ()
+    string(APPEND CONTENT "} // namespace ChippoParameterTable\n")
+
+    # only touch the file if it changed, so everything including it doesn't rebuild on every configure
+    file(WRITE ${OUTPUT_FILE}.tmp "${CONTENT}")
+    execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different ${OUTPUT_FILE}.tmp ${OUTPUT_FILE})
+    file(REMOVE ${OUTPUT_FILE}.tmp)
+endfunction()
@@ -1,27 +1,43 @@
 #include "CustomAudioEditor.h"
+#include "components/ParamIdentifiers.h"
+#include "components/ParameterTable.h"
+#include "state/StateFormat.h"
 #include <json/json.hpp>
 
 #ifdef RNBO_INCLUDE_DESCRIPTION_FILE
 #    include <rnbo_description.h>
 #endif
 
-//create an instance of our custom plugin, optionally set description, presets and binary data (datarefs)
-CustomAudioProcessor* CustomAudioProcessor::CreateDefault()
+#ifdef RNBO_BINARY_DATA_STORAGE_NAME
+extern RNBO::BinaryDataImpl::Storage RNBO_BINARY_DATA_STORAGE_NAME;
+#endif
+
+/**
+ * The export's datarefs, wrapped once for the whole process. Every instance is built from this
+ * rather than from its own copy of the storage, so adding instances doesn't copy the embedded data again.
+ */
+static const RNBO::BinaryData& getSharedBinaryData()
 {
-    nlohmann::json patcher_desc, presets;
 #ifdef RNBO_BINARY_DATA_STORAGE_NAME
-    extern RNBO::BinaryDataImpl::Storage RNBO_BINARY_DATA_STORAGE_NAME;
-    RNBO::BinaryDataImpl::Storage        dataStorage = RNBO_BINARY_DATA_STORAGE_NAME;
+    static const RNBO::BinaryDataImpl data (RNBO_BINARY_DATA_STORAGE_NAME);
 #else
-    RNBO::BinaryDataImpl::Storage dataStorage;
+    static const RNBO::BinaryDataImpl data { RNBO::BinaryDataImpl::Storage() };
 #endif
-    RNBO::BinaryDataImpl data (dataStorage);
+    return data;
+}
+
+//create an instance of our custom plugin, optionally set description, presets and binary data (datarefs)
+CustomAudioProcessor* CustomAudioProcessor::CreateDefault()
+{
+    auto& data = getSharedBinaryData();
 
+    // pass the description straight through, it's big and copying it for every instance adds up in large sessions
 #ifdef RNBO_INCLUDE_DESCRIPTION_FILE
-    patcher_desc = RNBO::patcher_description;
-    presets      = RNBO::patcher_presets;
-#endif
+    return new CustomAudioProcessor (RNBO::patcher_description, RNBO::patcher_presets, data);
+#else
+    static const nlohmann::json patcher_desc, presets;
     return new CustomAudioProcessor (patcher_desc, presets, data);
+#endif
 }
 
 CustomAudioProcessor::CustomAudioProcessor (const nlohmann::json&   patcher_desc,
@@ -36,7 +52,25 @@ CustomAudioProcessor::CustomAudioProcessor (const nlohmann::json&   patcher_desc
 
     appProperties.setStorageParameters (options);
 
+    ParameterTable::bind (*this, _rnboObject);
+
     setupSequencerPresetTree();
+    setupStateTracking();
+    setupParameterSenders();
+
+    // a sequence coming back from the patch means the saved state has changed
+    for (auto* tag: Outports::sequenceOuts)
+        outports.add (tag, [this] (const RNBO::MessageEvent&) { markStateDirty(); });
+}
+
+CustomAudioProcessor::~CustomAudioProcessor()
+{
+    for (auto* parameter: getParameters())
+        if (auto* param = dynamic_cast<RangedAudioParameter*> (parameter))
+            parameterSenders->remove (*param);
+
+    // the switcher calls back into members declared after it, which are destroyed before it is
+    presetSwitcher.stop();
 }
 
 juce::AudioProcessorEditor* CustomAudioProcessor::createEditor()
@@ -46,60 +80,127 @@ juce::AudioProcessorEditor* CustomAudioProcessor::createEditor()
 
 void CustomAudioProcessor::handleMessageEvent (const RNBO::MessageEvent& event)
 {
+    outports.dispatch (event);
     RNBO::JuceAudioProcessor::handleMessageEvent (event);
 }
 
+void CustomAudioProcessor::prepareToPlay (double sampleRate, int estimatedSamplesPerBlock)
+{
+    presetSwitcher.prepare (sampleRate);
+    transportFeed.prepare (sampleRate);
+    RNBO::JuceAudioProcessor::prepareToPlay (sampleRate, estimatedSamplesPerBlock);
+
+    // hosts usually say they're about to bounce before preparing, switch now so the first blocks are covered too
+    renderingMode.update (isNonRealtime());
+}
+
+void CustomAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    renderingMode.update (isNonRealtime());
+    commandBus.drain();
+    presetSwitcher.blockStarted (isRenderingOffline());
+    // the playhead is only for the editor, leave it be while bouncing
+    if (!isRenderingOffline())
+        transportFeed.blockStarted (buffer.getNumSamples());
+    RNBO::JuceAudioProcessor::processBlock (buffer, midiMessages);
+    if (!isRenderingOffline())
+        transportFeed.blockEnded();
+    presetSwitcher.applyFade (buffer);
+}
+
+void CustomAudioProcessor::processBlock (AudioBuffer<double>& buffer, MidiBuffer& midiMessages)
+{
+    renderingMode.update (isNonRealtime());
+    commandBus.drain();
+    presetSwitcher.blockStarted (isRenderingOffline());
+    // the playhead is only for the editor, leave it be while bouncing
+    if (!isRenderingOffline())
+        transportFeed.blockStarted (buffer.getNumSamples());
+    RNBO::JuceAudioProcessor::processBlock (buffer, midiMessages);
+    if (!isRenderingOffline())
+        transportFeed.blockEnded();
+    presetSwitcher.applyFade (buffer);
+}
+
 void CustomAudioProcessor::getStateInformation (MemoryBlock& destData)
 {
-    auto rnboPreset    = _rnboObject.getPresetSync();
-    auto rnboPresetStr = RNBO::convertPresetToJSON (*rnboPreset);
-    auto presetJSON    = nlohmann::json::parse (rnboPresetStr);
+    // a state set while playing is only applied once it's been faded in, until then that's the state
+    if (presetSwitcher.getPendingState (destData))
+        return;
 
-    presetJSON["presetName"]         = presetTree.getProperty ("CurrentPresetName").toString().toStdString();
-    presetJSON["presetFileLocation"] = presetTree.getProperty ("CurrentPresetFileLocation").toString().toStdString();
+    stateCache.get (destData);
+}
 
-    for (auto& i : SeqButtons::genIdts)
+void CustomAudioProcessor::captureState (MemoryBlock& destData)
+{
+    auto rnboPreset = _rnboObject.getPresetSync();
+
+    ChippoState::Metadata metadata;
     {
-        presetJSON[(sequencerVisIdt.toString() + i.toString()).toStdString()]
-            = presetTree.getChildWithName (sequencerVisIdt).getProperty (i).toString().toStdString();
+        const SpinLock::ScopedLockType lock (stateMetadataLock);
+        metadata = stateMetadata;
     }
 
-    MemoryOutputStream stream (destData, false);
-    stream.writeString (nlohmann::to_string (presetJSON));
+    ChippoState::write (destData, RNBO::convertPresetToJSONObj (*rnboPreset), metadata);
 }
 
 void CustomAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    juce::String rnboPresetStr = juce::String::createStringFromData (data, sizeInBytes);
-    auto         presetJSON    = nlohmann::json::parse (rnboPresetStr.toStdString());
+    auto size = static_cast<size_t> (jmax (0, sizeInBytes));
 
-    if (presetJSON.contains ("CurrentPresetName"))
+    // while playing, switching has to be faded and kept off the audio thread to avoid clicks and dropouts
+    if (presetSwitcher.canSwitchInBackground())
     {
-        presetTree.setProperty ("CurrentPresetName", presetJSON["presetName"], nullptr);
-        presetJSON.erase ("CurrentPresetName");
-        presetTree.setProperty ("CurrentPresetFileLocation", presetJSON["presetFileLocation"], nullptr);
-        presetJSON.erase ("CurrentPresetFileLocation");
+        presetSwitcher.load (data, size);
+        return;
     }
 
-    for (auto& i : SeqButtons::genIdts)
+    auto state = PreparedState::fromData (data, size);
+    if (state == nullptr)
     {
-        auto property = (sequencerVisIdt.toString() + i.toString()).toStdString();
-        if (presetJSON.contains (property))
-        {
-            presetTree.getChildWithName (sequencerVisIdt).setProperty (i, presetJSON[property], nullptr);
-            presetJSON.erase (property);
-        }
+        jassertfalse; // couldn't make sense of this state
+        return;
     }
+    setPreparedState (std::move (state));
+}
 
-    auto rnboPreset = RNBO::convertJSONToPreset (nlohmann::to_string (presetJSON));
+void CustomAudioProcessor::setPreparedState (std::unique_ptr<PreparedState> state)
+{
+    if (presetSwitcher.canSwitchInBackground())
+    {
+        presetSwitcher.load (std::move (state));
+        return;
+    }
 
-    _rnboObject.setPresetSync (std::move (rnboPreset));
+    presetSwitcher.applySync (std::move (state));
+}
 
-    static RNBO::MessageTag retrieveSequences { RNBO::TAG ("retrieveSequences") };
-    static RNBO::MessageTag bang { RNBO::TAG ("") };
-    _rnboObject.sendMessage (retrieveSequences, bang);
-    // now let us get all parameter updates that were triggered by the preset update immediately
+void CustomAudioProcessor::applyStateMetadata (const ChippoState::Metadata& metadata)
+{
+    if (metadata.presetName.isNotEmpty())
+    {
+        presetTree.setProperty ("CurrentPresetName", metadata.presetName, nullptr);
+        presetTree.setProperty ("CurrentPresetFileLocation", metadata.presetFileLocation, nullptr);
+    }
+
+    auto   seqTree = presetTree.getChildWithName (sequencerVisIdt);
+    uint32 bit     = 1;
+    for (auto& i: SeqButtons::genIdts)
+    {
+        seqTree.setProperty (i, (metadata.sequencerVisibility & bit) != 0, nullptr);
+        bit <<= 1;
+    }
+}
+
+void CustomAudioProcessor::presetSwitched()
+{
+    // the parameter updates the preset triggered, now rather than whenever the adapter gets to them, so they're
+    // all in before the switch counts as finished
     drainEvents();
+
+    static RNBO::MessageTag retrieveSequences { RNBO::TAG ("retrieveSequences") };
+    commandBus.sendBang (retrieveSequences);
+    markStateDirty();
 }
 
 bool CustomAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -119,3 +220,67 @@ void CustomAudioProcessor::setupSequencerPresetTree()
 
     presetTree.addChild (seqTree, -1, nullptr);
 }
+
+void CustomAudioProcessor::setupParameterSenders()
+{
+    // the adapter passes the value on to the parameter, and so the host, once RNBO has applied it
+    for (auto* parameter: getParameters())
+    {
+        auto* param = dynamic_cast<RangedAudioParameter*> (parameter);
+        if (param == nullptr)
+            continue;
+
+        auto index = _rnboObject.getParameterIndexForID (param->getParameterID().toRawUTF8());
+        if (!isPositiveAndBelow (index, _rnboObject.getNumParameters()))
+            continue;
+
+        parameterSenders->add (*param,
+                               [this, param, index] (float normalisedValue)
+                               { commandBus.setParameter (index, param->convertFrom0to1 (normalisedValue)); });
+    }
+}
+
+void CustomAudioProcessor::setupStateTracking()
+{
+    for (auto* parameter: getParameters())
+        if (auto* param = dynamic_cast<RangedAudioParameter*> (parameter))
+            stateCallbacks.add (*param, nlt::APVTSCallbacks::sync, [this] (float) { markStateDirty(); });
+
+    auto updateMetadata = [this] (auto&& update)
+    {
+        {
+            const SpinLock::ScopedLockType lock (stateMetadataLock);
+            update (stateMetadata);
+        }
+        markStateDirty();
+    };
+
+    presetTreeCallbacks.add (presetTree,
+                             "CurrentPresetName",
+                             [updateMetadata] (const var& name)
+                             { updateMetadata ([&name] (auto& m) { m.presetName = name.toString(); }); });
+    presetTreeCallbacks.add (presetTree,
+                             "CurrentPresetFileLocation",
+                             [updateMetadata] (const var& location)
+                             { updateMetadata ([&location] (auto& m) { m.presetFileLocation = location.toString(); }); });
+
+    auto   seqTree = presetTree.getChildWithName (sequencerVisIdt);
+    uint32 bit     = 1;
+    for (auto& i: SeqButtons::genIdts)
+    {
+        presetTreeCallbacks.add (seqTree,
+                                 i,
+                                 [updateMetadata, bit] (bool show)
+                                 {
+                                     updateMetadata (
+                                         [show, bit] (auto& m)
+                                         {
+                                             if (show)
+                                                 m.sequencerVisibility |= bit;
+                                             else
+                                                 m.sequencerVisibility &= ~bit;
+                                         });
+                                 });
+        bit <<= 1;
+    }
+}
@@ -4,21 +4,50 @@
 #include "RNBO_BinaryData.h"
 #include <json/json.hpp>
 #include <JuceHeader.h>
+#include "state/StateFormat.h"
+#include "state/StateCache.h"
+#include "state/PresetSwitcher.h"
+#include "messaging/MessageRouter.h"
+#include "messaging/TransportFeed.h"
+#include "messaging/CommandBus.h"
+#include "parameter-handling/APVTSCallback.h"
+#include "parameter-handling/ParameterSenders.h"
+#include "parameter-handling/ValueTreeCallback.h"
 
 class CustomAudioProcessor : public RNBO::JuceAudioProcessor
 {
 public:
     static CustomAudioProcessor* CreateDefault();
     CustomAudioProcessor (const nlohmann::json& patcher_desc, const nlohmann::json& presets, const RNBO::BinaryData& data);
+    ~CustomAudioProcessor() override;
     juce::AudioProcessorEditor* createEditor() override;
 
     void handleMessageEvent (const RNBO::MessageEvent& event) override;
 
+    void prepareToPlay (double sampleRate, int estimatedSamplesPerBlock) override;
+    void processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
+    void processBlock (AudioBuffer<double>& buffer, MidiBuffer& midiMessages) override;
+
     void getStateInformation (MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
+    /** Applies a state decoded ahead of time with PreparedState::fromData */
+    void setPreparedState (std::unique_ptr<PreparedState> state);
+
+    /** Everything sent to the RNBO object from outside the audio thread goes through here */
+    CommandBus& getCommandBus() noexcept { return commandBus; }
+
+    /** Call this when something that ends up in the saved state changes without going through a parameter */
+    void markStateDirty() noexcept { stateCache.markDirty(); }
+
+    /** True until a loaded preset and every parameter change it makes are in, see PresetSwitcher::isSwitching */
+    bool isSwitchingPreset() const noexcept { return presetSwitcher.isSwitching(); }
+
+    /** True while the host is bouncing. Nobody is watching then, so UI-only work can be skipped */
+    bool isRenderingOffline() const noexcept { return renderingMode.isOffline(); }
+
     friend class CustomAudioEditor;
     friend class EditorContainer;
 
@@ -26,8 +55,51 @@ private:
     juce::OwnedArray<RNBO::list> sequences;
     juce::ValueTree              presetTree { "presetTree" };
     juce::ApplicationProperties  appProperties;
+    CommandBus                   commandBus { _rnboObject };
+    // sends the editor's parameter changes through commandBus
+    juce::SharedResourcePointer<nlt::ParameterSenders> parameterSenders;
+
+    // a copy of the preset tree's saved properties, so the state can be captured off the message thread
+    ChippoState::Metadata   stateMetadata;
+    juce::SpinLock          stateMetadataLock;
+    nlt::APVTSCallbacks     stateCallbacks;
+    nlt::ValueTreeCallbacks presetTreeCallbacks;
+    MessageRouter           outports;
+    // where the playhead is, for the editor
+    TransportFeed transportFeed { _rnboObject };
+    // decodes and fades in presets loaded while the audio is running
+    PresetSwitcher presetSwitcher { _rnboObject,
+                                    [this] (const ChippoState::Metadata& m) { applyStateMetadata (m); },
+                                    [this] { presetSwitched(); } };
+    /** Follows isNonRealtime() from the audio thread, through a flag this processor's async callbacks check as they're called */
+    struct RenderingMode
+    {
+        explicit RenderingMode (nlt::APVTSCallbacks& c)
+            : callbacks (c)
+        {
+        }
+
+        /** Any thread */
+        void update (bool isNonRealtime) noexcept { callbacks.setOfflineMode (isNonRealtime); }
+
+        bool isOffline() const noexcept { return callbacks.isOfflineMode(); }
+
+    private:
+        nlt::APVTSCallbacks& callbacks;
+
+        JUCE_DECLARE_NON_COPYABLE (RenderingMode)
+    };
+
+    RenderingMode renderingMode { stateCallbacks };
+    // keep this last so its timer stops before anything it captures is destroyed
+    StateCache stateCache { [this] (MemoryBlock& dest) { captureState (dest); } };
 
     void setupSequencerPresetTree();
+    void setupStateTracking();
+    void setupParameterSenders();
+    void captureState (MemoryBlock& destData);
+    void applyStateMetadata (const ChippoState::Metadata& metadata);
+    void presetSwitched();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CustomAudioProcessor)
 };
@@ -0,0 +1,106 @@
+#include "JuceHeader.h"
+#include "offline/OfflineRenderer.h"
+#include "offline/BatchRenderer.h"
+#include "state/PresetBank.h"
+
+/*
+    Headless renderer. Renders .hop presets to wav files as fast as the CPU allows.
+
+    single preset:  ChippoRender --preset <file.hop> --out <file.wav> [options]
+    preset folder:  ChippoRender --presets <folder or .hopbank> --out <folder> [--jobs <num cpus>] [options]
+    preset banks:   ChippoRender --export-bank <folder> --out <file.hopbank>
+                    ChippoRender --import-bank <file.hopbank> --out <folder>
+
+    options:        [--bars 4] [--bpm 120] [--sr 48000] [--block 512] [--bits 24] [--seed 0]
+*/
+
+static void printUsage()
+{
+    std::cout << "usage: ChippoRender --preset <file.hop> --out <file.wav> [options]\n"
+                 "       ChippoRender --presets <folder or .hopbank> --out <folder> [--jobs <num cpus>] [options]\n"
+                 "       ChippoRender --export-bank <folder> --out <file.hopbank>\n"
+                 "       ChippoRender --import-bank <file.hopbank> --out <folder>\n"
+                 "options: [--bars 4] [--bpm 120] [--sr 48000] [--block 512] [--bits 24] [--seed 0]"
+              << std::endl;
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    auto isBatch  = args.containsOption ("--presets");
+    auto isExport = args.containsOption ("--export-bank");
+    auto isImport = args.containsOption ("--import-bank");
+    if (args.containsOption ("--help|-h") || !(isBatch || isExport || isImport || args.containsOption ("--preset"))
+        || !args.containsOption ("--out"))
+    {
+        printUsage();
+        return args.containsOption ("--help|-h") ? 0 : 1;
+    }
+
+    if (isExport || isImport)
+    {
+        auto source = args.getFileForOption (isExport ? "--export-bank" : "--import-bank");
+        auto dest   = args.getFileForOption ("--out");
+        auto result = isExport ? PresetBank::exportFolder (source, "hop", dest)
+                               : PresetBank::importToFolder (source, dest, "hop");
+        if (result.failed())
+            std::cerr << result.getErrorMessage() << std::endl;
+        return result.wasOk() ? 0 : 1;
+    }
+
+    // the processor owns AsyncUpdaters and a ValueTree, so it needs a message manager even without a window
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    OfflineRenderer::Settings settings;
+    auto getOption = [&args] (juce::StringRef option, auto defaultValue)
+    {
+        auto value = args.getValueForOption (option);
+        return value.isEmpty() ? defaultValue : static_cast<decltype (defaultValue)> (value.getDoubleValue());
+    };
+    settings.numBars    = getOption ("--bars", settings.numBars);
+    settings.bpm        = getOption ("--bpm", settings.bpm);
+    settings.sampleRate = getOption ("--sr", settings.sampleRate);
+    settings.blockSize  = getOption ("--block", settings.blockSize);
+    settings.bitDepth   = getOption ("--bits", settings.bitDepth);
+    settings.seed       = args.getValueForOption ("--seed").getLargeIntValue();
+
+    auto presetFile = args.getFileForOption (isBatch ? "--presets" : "--preset");
+    auto outputFile = args.getFileForOption ("--out");
+    if (isBatch ? !(presetFile.isDirectory() || presetFile.hasFileExtension (PresetBank::fileExtension))
+                : !(presetFile.existsAsFile() || PresetBank::findBankFor (presetFile) != juce::File()))
+    {
+        std::cerr << "no preset at " << presetFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    auto start = juce::Time::getMillisecondCounterHiRes();
+
+    if (isBatch)
+    {
+        BatchRenderer renderer (settings, getOption ("--jobs", juce::SystemStats::getNumCpus()));
+
+        auto numFailed = renderer.render (presetFile, outputFile);
+        auto took      = juce::Time::getMillisecondCounterHiRes() - start;
+
+        std::cout << outputFile.getFullPathName() << ": finished in " << took << " ms, " << numFailed << " failed"
+                  << std::endl;
+        return numFailed == 0 ? 0 : 1;
+    }
+
+    OfflineRenderer renderer (settings);
+
+    auto result = renderer.render (presetFile, outputFile);
+    auto took   = juce::Time::getMillisecondCounterHiRes() - start;
+
+    if (result.failed())
+    {
+        std::cerr << result.getErrorMessage() << std::endl;
+        return 1;
+    }
+
+    auto renderedMs = 1000.0 * static_cast<double> (renderer.getNumSamplesToRender()) / settings.sampleRate;
+    std::cout << outputFile.getFullPathName() << ": " << renderedMs << " ms of audio in " << took << " ms ("
+              << renderedMs / juce::jmax (took, 0.001) << "x realtime)" << std::endl;
+    return 0;
+}
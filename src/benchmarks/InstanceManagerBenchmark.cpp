@@ -0,0 +1,167 @@
+#include "JuceHeader.h"
+#include "instance-management/InstanceManager.h"
+
+/*
+    Microbenchmark for nlt::InstanceManager.
+
+    Times adding and removing instances against the vector + linear search registry it replaced, and how long
+    registrations wait while a slow forEachInstance pass is running on another thread.
+
+    InstanceManagerBenchmark [--instances 10000] [--rounds 5]
+*/
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct BenchInstance;
+
+struct BenchManager : public nlt::InstanceManager<BenchInstance>
+{
+    template <typename Function>
+    void visitAll (Function&& function)
+    {
+        forEachInstance (std::forward<Function> (function));
+    }
+};
+
+struct BenchInstance : public nlt::ManagedInstance<BenchInstance, BenchManager, false>
+{
+    BenchManager& getManager() noexcept { return getInstanceManager(); }
+
+    std::atomic<int> visits { 0 };
+};
+
+/** What InstanceManager used to do, a linear search on every add and remove */
+struct LinearRegistry
+{
+    void addInstance (BenchInstance* instance)
+    {
+        const juce::SpinLock::ScopedLockType lock (instancesLock);
+        if (std::find (instances.begin(), instances.end(), instance) == instances.end())
+            instances.push_back (instance);
+    }
+
+    void removeInstance (BenchInstance* instance)
+    {
+        const juce::SpinLock::ScopedLockType lock (instancesLock);
+        auto found = std::find (instances.begin(), instances.end(), instance);
+        if (found != instances.end())
+            instances.erase (found);
+    }
+
+    juce::SpinLock              instancesLock;
+    std::vector<BenchInstance*> instances;
+};
+
+double toNanoseconds (Clock::duration duration)
+{
+    return static_cast<double> (std::chrono::duration_cast<std::chrono::nanoseconds> (duration).count());
+}
+
+/** Adds every instance then removes them in a random order, like editors opening and closing in a big session */
+template <typename Registry>
+double timeAddRemove (Registry& registry, std::vector<std::unique_ptr<BenchInstance>>& pool, juce::Random& random)
+{
+    std::vector<BenchInstance*> order;
+    for (auto& instance: pool)
+        order.push_back (instance.get());
+
+    auto start = Clock::now();
+    for (auto* instance: order)
+        registry.addInstance (instance);
+
+    for (size_t i = order.size(); i > 1; --i)
+        std::swap (order[i - 1], order[static_cast<size_t> (random.nextInt (static_cast<int> (i)))]);
+
+    for (auto* instance: order)
+        registry.removeInstance (instance);
+
+    return toNanoseconds (Clock::now() - start) / static_cast<double> (2 * pool.size());
+}
+
+/** The longest a single add + remove waits while another thread runs passes that take a while per instance */
+double timeRegistrationDuringPass (BenchManager& manager, std::vector<std::unique_ptr<BenchInstance>>& pool)
+{
+    for (auto& instance: pool)
+        manager.addInstance (instance.get());
+
+    std::atomic<bool> passing { true };
+    std::thread       passer (
+        [&]
+        {
+            while (passing)
+            {
+                manager.visitAll (
+                    [] (BenchInstance& instance)
+                    {
+                        instance.visits++;
+                        auto until = Clock::now() + std::chrono::microseconds (20);
+                        while (Clock::now() < until)
+                        {
+                        }
+                    });
+            }
+        });
+
+    BenchInstance   extra;
+    Clock::duration longest {};
+    for (auto i = 0; i < 2000; ++i)
+    {
+        auto start = Clock::now();
+        manager.addInstance (&extra);
+        manager.removeInstance (&extra);
+        longest = std::max (longest, Clock::now() - start);
+    }
+
+    passing = false;
+    passer.join();
+
+    for (auto& instance: pool)
+        manager.removeInstance (instance.get());
+
+    return toNanoseconds (longest);
+}
+} // namespace
+
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+    auto               getOption = [&args] (juce::StringRef option, int defaultValue)
+    {
+        auto value = args.getValueForOption (option);
+        return value.isEmpty() ? defaultValue : juce::jmax (1, value.getIntValue());
+    };
+    auto numInstances = getOption ("--instances", 10000);
+    auto numRounds    = getOption ("--rounds", 5);
+
+    juce::Random random (1);
+
+    for (auto count = 10; count <= numInstances; count *= 10)
+    {
+        std::vector<std::unique_ptr<BenchInstance>> pool;
+        for (auto i = 0; i < count; ++i)
+            pool.push_back (std::make_unique<BenchInstance>());
+
+        auto&          manager = pool.front()->getManager();
+        LinearRegistry linear;
+
+        double managerNs = 0, linearNs = 0;
+        for (auto round = 0; round < numRounds; ++round)
+        {
+            managerNs += timeAddRemove (manager, pool, random);
+            linearNs += timeAddRemove (linear, pool, random);
+        }
+
+        std::cout << count << " instances: add/remove " << managerNs / numRounds << " ns (InstanceManager), "
+                  << linearNs / numRounds << " ns (linear search)" << std::endl;
+    }
+
+    std::vector<std::unique_ptr<BenchInstance>> pool;
+    for (auto i = 0; i < 100; ++i)
+        pool.push_back (std::make_unique<BenchInstance>());
+    std::cout << "longest add + remove during a pass over 100 instances at 20 us each: "
+              << timeRegistrationDuringPass (pool.front()->getManager(), pool) / 1000.0 << " us" << std::endl;
+
+    return 0;
+}
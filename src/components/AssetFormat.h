@@ -0,0 +1,113 @@
+#pragma once
+#include "JuceHeader.h"
+
+/**
+ * The pre-decoded image format the build embeds instead of PNGs, shared by the tool that writes it
+ * (src/tools/CompileAssets.cpp) and Assets, which loads it.
+ *
+ * A 16 byte header: "CPIX", then the width, height and compression as little endian int32s. Then every row,
+ * top to bottom, of premultiplied pixels stored as blue, green, red, alpha bytes, which is PixelARGB's own
+ * layout on every desktop platform. Loading is a copy, or an inflate straight into the image where it was
+ * worth compressing, with no filtering, unpremultiplying or format conversion like a PNG needs.
+ */
+namespace AssetFormat
+{
+using namespace juce;
+
+static constexpr const char* extension     = ".pix";
+static constexpr const char  magic[]       = "CPIX";
+static constexpr int         headerSize    = 16;
+static constexpr int         bytesPerPixel = 4;
+
+enum Compression
+{
+    stored   = 0,
+    deflated = 1
+};
+
+struct Header
+{
+    int         width { 0 };
+    int         height { 0 };
+    Compression compression { stored };
+};
+
+/** False if data isn't this format */
+inline bool readHeader (const void* data, size_t size, Header& header)
+{
+    auto bytes = static_cast<const char*> (data);
+    if (bytes == nullptr || size < headerSize || std::memcmp (bytes, magic, 4) != 0)
+        return false;
+
+    header.width       = static_cast<int> (ByteOrder::littleEndianInt (bytes + 4));
+    header.height      = static_cast<int> (ByteOrder::littleEndianInt (bytes + 8));
+    header.compression = static_cast<Compression> (ByteOrder::littleEndianInt (bytes + 12));
+    return header.width > 0 && header.height > 0 && (header.compression == stored || header.compression == deflated);
+}
+
+inline void writePixel (uint8* dest, const PixelARGB& pixel) noexcept
+{
+    dest[0] = pixel.getBlue();
+    dest[1] = pixel.getGreen();
+    dest[2] = pixel.getRed();
+    dest[3] = pixel.getAlpha();
+}
+
+/** Whether a row of stored pixels can be copied into an Image as it is */
+inline bool isNativeLayout() noexcept
+{
+    PixelARGB pixel;
+    pixel.setARGB (4, 3, 2, 1);
+    const uint8 expected[] = { 1, 2, 3, 4 };
+    return std::memcmp (&pixel, expected, sizeof (expected)) == 0;
+}
+
+/** Makes an ARGB Image from an embedded blob, invalid if it's not this format or is cut short */
+inline Image decode (const void* data, size_t size)
+{
+    Header header;
+    if (!readHeader (data, size, header))
+        return {};
+
+    auto rowBytes = static_cast<size_t> (header.width) * bytesPerPixel;
+    auto pixels   = static_cast<const char*> (data) + headerSize;
+    auto numBytes = size - headerSize;
+    if (header.compression == stored && numBytes < rowBytes * static_cast<size_t> (header.height))
+        return {};
+
+    MemoryInputStream                            source (pixels, numBytes, false);
+    std::unique_ptr<GZIPDecompressorInputStream> inflater;
+    if (header.compression == deflated)
+        inflater = std::make_unique<GZIPDecompressorInputStream> (source);
+
+    Image             image (Image::ARGB, header.width, header.height, false);
+    Image::BitmapData bitmap (image, Image::BitmapData::writeOnly);
+    const auto        native = isNativeLayout() && bitmap.pixelStride == bytesPerPixel;
+    HeapBlock<uint8>  converted (native ? 0 : rowBytes);
+
+    for (auto y = 0; y < header.height; ++y)
+    {
+        auto line = native ? bitmap.getLinePointer (y) : converted.get();
+        if (inflater != nullptr)
+        {
+            if (inflater->read (line, static_cast<int> (rowBytes)) != static_cast<int> (rowBytes))
+                return {};
+        }
+        else
+        {
+            std::memcpy (line, pixels + rowBytes * static_cast<size_t> (y), rowBytes);
+        }
+
+        if (native)
+            continue;
+
+        for (auto x = 0; x < header.width; ++x)
+        {
+            auto src = converted + x * bytesPerPixel;
+            reinterpret_cast<PixelARGB*> (bitmap.getPixelPointer (x, y))->setARGB (src[3], src[2], src[1], src[0]);
+        }
+    }
+    return image;
+}
+
+} // namespace AssetFormat
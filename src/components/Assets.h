@@ -0,0 +1,86 @@
+#pragma once
+#include "JuceHeader.h"
+#include "BinaryData.h"
+#include "AssetFormat.h"
+
+/**
+ * Embedded images, ready to draw and at the size they're drawn at.
+ *
+ * The build decodes every image in assets/images once and embeds its pixels, along with smaller copies of it,
+ * each half the size of the one before (see assets/CMakeLists.txt and AssetFormat). Loading one is a copy or an
+ * inflate rather than a PNG decode, and loading the smallest copy that still covers the pixels being drawn means
+ * far less to load, keep in memory and resample, especially when zoomed out.
+ *
+ * Images are named after their file in assets/images without the extension, e.g. "Cookie1".
+ */
+namespace Assets
+{
+using namespace juce;
+
+/** How many halvings the build makes of each image, keep this the same as MIP_LEVELS in assets/CMakeLists.txt */
+static constexpr int numMipLevels = 6;
+
+/** BinaryData's name for an embedded file, it swaps anything that can't go in an identifier for an underscore */
+inline String getResourceName (const String& imageName, int level = 0)
+{
+    auto fileName = imageName + (level > 0 ? "_mip" + String (level) : String()) + AssetFormat::extension;
+    return fileName.replaceCharacters (" .-", "___");
+}
+
+/** The size of an embedded image at full size, from its header so nothing is loaded. Empty if there's none by that name */
+inline Rectangle<int> getFullBounds (const String& imageName)
+{
+    int                 size = 0;
+    auto                data = BinaryData::getNamedResource (getResourceName (imageName).toRawUTF8(), size);
+    AssetFormat::Header header;
+    if (!AssetFormat::readHeader (data, static_cast<size_t> (jmax (0, size)), header))
+        return {};
+
+    return { header.width, header.height };
+}
+
+/** Loads one embedded level through the ImageCache, so it's only ever loaded once while it's in use */
+inline Image loadLevel (const String& imageName, int level)
+{
+    int  size = 0;
+    auto data = BinaryData::getNamedResource (getResourceName (imageName, level).toRawUTF8(), size);
+    if (data == nullptr)
+        return {};
+
+    // the same key ImageCache::getFromMemory would use, the embedded data never moves
+    auto hashCode = static_cast<int64> (reinterpret_cast<pointer_sized_int> (data));
+    auto image    = ImageCache::getFromHashCode (hashCode);
+    if (!image.isValid())
+    {
+        image = AssetFormat::decode (data, static_cast<size_t> (size));
+        ImageCache::addImageToCache (image, hashCode);
+    }
+    return image;
+}
+
+/** Loads an embedded image at full size */
+inline Image getImage (const String& imageName) { return loadLevel (imageName, 0); }
+
+/**
+ * Loads an embedded image at the smallest size that's at least pixelWidth x pixelHeight.
+ * Falls back to the full size image when it's smaller than that already.
+ */
+inline Image getImage (const String& imageName, int pixelWidth, int pixelHeight)
+{
+    auto full = getFullBounds (imageName);
+
+    // from the smallest up, the first one that's big enough
+    for (auto level = numMipLevels; level > 0 && !full.isEmpty(); --level)
+    {
+        if (jmax (1, full.getWidth() >> level) < pixelWidth || jmax (1, full.getHeight() >> level) < pixelHeight)
+            continue;
+
+        auto mip = loadLevel (imageName, level);
+        if (mip.isValid())
+            return mip;
+    }
+
+    return getImage (imageName);
+}
+
+} // namespace Assets
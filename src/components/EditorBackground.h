@@ -1,5 +1,6 @@
 #pragma once
 #include <JuceHeader.h>
+#include "Assets.h"
 //#include "LookAndFeel/ChippoLookAndFeel.h"
 
 struct EditorBackground : public Component
@@ -9,7 +10,7 @@ struct EditorBackground : public Component
         setRepaintsOnMouseActivity (false);
         setBufferedToImage (true);
         setOpaque (true);
-        bannerImg.setImage (ImageCache::getFromMemory (BinaryData::Banner_png, BinaryData::Banner_pngSize));
+        bannerImg.setImage (Assets::getImage ("Banner"));
         bannerImg.setOpaque (true);
         addAndMakeVisible (bannerImg);
     }
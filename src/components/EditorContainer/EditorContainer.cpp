@@ -1,13 +1,18 @@
 #include "EditorContainer.h"
-#include "BinaryData.h"
+#include "components/Assets.h"
 #include "utilities/MidiNoteNumberFromName.h"
+#include "components/ParameterTable.h"
 
 using namespace juce;
 
+// asks the patch to send every sequence out again
+static const RNBO::MessageTag retrieveSequences { RNBO::TAG ("retrieveSequences") };
+
 EditorContainer::EditorContainer (CustomAudioProcessor* const p, RNBO::CoreObject& rnboObject)
     : _audioProcessor (p)
     , rnboProcessor (p)
     , _rnboObject (rnboObject)
+    , commandBus (p->getCommandBus())
     , appProperties (p->appProperties)
     , presetTree (p->presetTree)
     , presetBar ({}, p->presetTree)
@@ -20,16 +25,18 @@ EditorContainer::EditorContainer (CustomAudioProcessor* const p, RNBO::CoreObjec
     saveLocation.createDirectory();
     saveLocation.setReadOnly (false);
 
-    presetBar.setSaveLocation (saveLocation);
-    presetBar.setFileExtension ("hop");
+    presetBar.setSaveLocation (saveLocation, "hop");
 
     presetBar.setSaveFn ([this] (MemoryBlock& destData) { _audioProcessor->getStateInformation (destData); });
     presetBar.setLoadFn ([this] (MemoryBlock& loadData)
                          { _audioProcessor->setStateInformation (loadData.getData(), static_cast<int> (loadData.getSize())); });
+    presetBar.setLoadPreparedFn ([this] (std::unique_ptr<PreparedState> state)
+                                 { _audioProcessor->setPreparedState (std::move (state)); });
 
     addAndMakeVisible (presetBar);
 
     setupSequencers();
+    setupOutports();
 
     addAndMakeVisible (melodySequencer);
     addAndMakeVisible (bassSequencer);
@@ -38,16 +45,21 @@ EditorContainer::EditorContainer (CustomAudioProcessor* const p, RNBO::CoreObjec
     addAndMakeVisible (hatSequencer);
     addAndMakeVisible (seqStepIndicator);
     setupSliders();
+    setupEnvelopeGroups();
     setupButtons();
     setupToggles();
     setupTooltips();
     addChildComponent (aboutPanel);
 
-    static RNBO::MessageTag retrieveSequences { RNBO::TAG ("retrieveSequences") };
-    static RNBO::MessageTag bang { RNBO::TAG ("") };
-    _rnboObject.sendMessage (retrieveSequences, bang);
+    commandBus.sendBang (retrieveSequences);
     setRepaintsOnMouseActivity (false);
 
+    _audioProcessor->transportFeed.setListening (true);
+    // read the playhead on every frame
+    playheadAction.setAction ([this] { updatePlayhead(); });
+    playheadAction.setSuspendedWhileHidden (true);
+    playheadAction.setTimerMs (0);
+
     setSizeFromSequencers();
 
     auto props = appProperties.getCommonSettings (true);
@@ -66,6 +78,7 @@ void EditorContainer::setScale (float newScale)
 
 EditorContainer::~EditorContainer()
 {
+    _audioProcessor->transportFeed.setListening (false);
     setLookAndFeel (nullptr);
 }
 
@@ -184,57 +197,66 @@ void EditorContainer::resized()
 
 void EditorContainer::handleMessageEvent (const RNBO::MessageEvent& event)
 {
-    static RNBO::MessageTag melodyTag { RNBO::TAG ("melodySequenceOut") };
-    static RNBO::MessageTag bassTag { RNBO::TAG ("bassSequenceOut") };
-    static RNBO::MessageTag kickTag { RNBO::TAG ("kickSequenceOut") };
-    static RNBO::MessageTag snareTag { RNBO::TAG ("snareSequenceOut") };
-    static RNBO::MessageTag hatTag { RNBO::TAG ("hatSequenceOut") };
-    static RNBO::MessageTag stepPosition { RNBO::TAG ("stepPosition") };
-    static RNBO::MessageTag transportBPM { RNBO::TAG ("presetMessage") };
-
-    if (event.getTag() == stepPosition)
-    {
-        currentStep = static_cast<int> (event.getNumValue());
-    }
-    else if (event.getTag() == melodyTag)
-    {
-        melodySequencer.setSequenceWithEvent (event);
-    }
-    else if (event.getTag() == hatTag)
-    {
-        hatSequencer.setSequenceWithEvent (event);
-    }
-    else if (event.getTag() == bassTag)
-    {
-        bassSequencer.setSequenceWithEvent (event);
-    }
-    else if (event.getTag() == kickTag)
-    {
-        kickSequencer.setSequenceWithEvent (event);
-    }
-    else if (event.getTag() == snareTag)
+    // nobody's watching a bounce, catch up with the patch once it's over instead
+    if (_audioProcessor->isRenderingOffline())
     {
-        snareSequencer.setSequenceWithEvent (event);
+        missedOutports = true;
+        return;
     }
+    outports.dispatch (event);
 }
 
-void EditorContainer::sendSequencerValues (SequencerComponent& seq, StringRef inputTag)
+void EditorContainer::setupOutports()
 {
-    auto newValues = seq.getCurrentSequence();
-    auto newList   = RNBO::make_unique<RNBO::list>();
-    newList->reserve (newValues.size());
-    for (auto v: newValues)
-        newList->push (static_cast<int> (v));
-    _parameterInterface->sendMessage (RNBO::TAG (inputTag), std::move (newList));
+    outports.add (Outports::melodySequenceOut,
+                  [this] (const RNBO::MessageEvent& event) { melodySequencer.setSequenceWithEvent (event); });
+    outports.add (Outports::bassSequenceOut,
+                  [this] (const RNBO::MessageEvent& event) { bassSequencer.setSequenceWithEvent (event); });
+    outports.add (Outports::kickSequenceOut,
+                  [this] (const RNBO::MessageEvent& event) { kickSequencer.setSequenceWithEvent (event); });
+    outports.add (Outports::snareSequenceOut,
+                  [this] (const RNBO::MessageEvent& event) { snareSequencer.setSequenceWithEvent (event); });
+    outports.add (Outports::hatSequenceOut,
+                  [this] (const RNBO::MessageEvent& event) { hatSequencer.setSequenceWithEvent (event); });
+    outports.add (Outports::melodyStepOut,
+                  [this] (const RNBO::MessageEvent& event) { melodySequencer.setSequenceWithEvent (event); });
+    outports.add (Outports::bassStepOut,
+                  [this] (const RNBO::MessageEvent& event) { bassSequencer.setSequenceWithEvent (event); });
+    outports.add (Outports::kickStepOut,
+                  [this] (const RNBO::MessageEvent& event) { kickSequencer.setSequenceWithEvent (event); });
+    outports.add (Outports::snareStepOut,
+                  [this] (const RNBO::MessageEvent& event) { snareSequencer.setSequenceWithEvent (event); });
+    outports.add (Outports::hatStepOut,
+                  [this] (const RNBO::MessageEvent& event) { hatSequencer.setSequenceWithEvent (event); });
 }
 
-static auto checkSliderType = [] (auto& sliderGroup, auto& p) -> Identifier
+void EditorContainer::updatePlayhead()
 {
-    for (auto& paramIdt: sliderGroup)
-        if (paramIdt.toString() == p->getParameterID())
-            return paramIdt;
-    return {};
-};
+    if (_audioProcessor->isRenderingOffline())
+        return;
+
+    if (missedOutports)
+    {
+        missedOutports = false;
+        commandBus.sendBang (retrieveSequences);
+    }
+
+    auto position = _audioProcessor->transportFeed.getPosition (Time::getMillisecondCounterHiRes());
+    if (position >= 0.0)
+        seqStepIndicator.setCurrentStep (static_cast<int> (position));
+}
+
+void EditorContainer::sendSequencerValues (SequencerComponent& seq, RNBO::MessageTag stepIn)
+{
+    // only the step that was clicked goes to the patch, as one number rather than the whole sequence
+    auto step = seq.getLastEditedStep();
+    if (step < 0)
+        return;
+
+    auto on = SequenceWire::isSet (seq.getCurrentSequence(), step);
+    commandBus.sendMessage (stepIn, SequenceWire::encodeStep (step, on));
+    _audioProcessor->markStateDirty();
+}
 
 void EditorContainer::setupSliders()
 {
@@ -242,68 +264,59 @@ void EditorContainer::setupSliders()
 
     int milkAlternator = 0;
     // clip off the top of the "fill" image so the slider better resembles a glass
-    auto milkFillOne = ImageCache::getFromMemory (BinaryData::Milk1_Full_png, BinaryData::Milk1_Full_pngSize);
-    milkFillOne.clear (milkFillOne.getBounds().removeFromTop (milkFillOne.getBounds().proportionOfHeight (0.07f)),
-                       Colours::transparentBlack);
-    auto milkFillTwo = ImageCache::getFromMemory (BinaryData::Milk2_Full_png, BinaryData::Milk2_Full_pngSize);
-    milkFillTwo.clear (milkFillTwo.getBounds().removeFromTop (milkFillTwo.getBounds().proportionOfHeight (0.07f)),
-                       Colours::transparentBlack);
+    auto milkFillClear = 0.07f;
 
     int cookieAlternator = 0;
     for (auto& parameter: parameters)
     {
         if (auto* param = dynamic_cast<RangedAudioParameter*> (parameter))
         {
-            auto paramIdt = checkSliderType (Sliders::allIdts, param);
-            if (paramIdt.isValid())
+            auto paramIdt = ParameterTable::getIdentifier (*param);
+            if (ParameterTable::contains (Sliders::allIdts, paramIdt))
             {
                 bool isLinearBarVerticalSlider { false };
-                if (Sliders::reverbLevel.toString() == param->getParameterID())
+                if (paramIdt == Sliders::reverbLevel)
                 {
                     auto slider = std::make_unique<ParamSliderRotary> (param);
-                    slider->addImage (ImageCache::getFromMemory (BinaryData::CookieSugar1_png, BinaryData::CookieSugar1_pngSize));
+                    slider->addImage ("CookieSugar1");
                     sliders[paramIdt] = std::move (slider);
                 }
                 // gain sliders use milk glasses
-                else if (checkSliderType (Sliders::trackGainIdts, param).isValid())
+                else if (ParameterTable::contains (Sliders::trackGainIdts, paramIdt))
                 {
                     auto slider = std::make_unique<ParamSliderLinearVertical> (param);
                     if (milkAlternator++ % 2)
                     {
-                        slider->setImageBg (ImageCache::getFromMemory (BinaryData::Milk1_png, BinaryData::Milk1_pngSize));
-                        slider->setImageFill (milkFillOne);
+                        slider->setImageBg ("Milk1");
+                        slider->setImageFill ("Milk1_Full", milkFillClear);
                     }
                     else
                     {
-                        slider->setImageBg (ImageCache::getFromMemory (BinaryData::Milk2_png, BinaryData::Milk2_pngSize));
-                        slider->setImageFill (milkFillTwo);
+                        slider->setImageBg ("Milk2");
+                        slider->setImageFill ("Milk2_Full", milkFillClear);
                     }
                     sliders[paramIdt] = std::move (slider);
                 }
                 // octave sliders are spoons
-                else if (checkSliderType (Sliders::octaveIdts, param).isValid())
+                else if (ParameterTable::contains (Sliders::octaveIdts, paramIdt))
                 {
                     auto slider = std::make_unique<ParamSliderLinearVertical> (param);
-                    slider->setImageBg (
-                        ImageCache::getFromMemory (BinaryData::SpoonOutline_png, BinaryData::SpoonOutline_pngSize));
-                    slider->setImageFill (ImageCache::getFromMemory (BinaryData::spoon_png, BinaryData::spoon_pngSize));
+                    slider->setImageBg ("SpoonOutline");
+                    slider->setImageFill ("spoon");
                     sliders[paramIdt] = std::move (slider);
                 }
                 // melodyWaveshape and glide get candy coated chips
-                else if (Sliders::melodyWaveshape.toString() == param->getParameterID()
-                         || Sliders::bassSlide.toString() == param->getParameterID())
+                else if (paramIdt == Sliders::melodyWaveshape || paramIdt == Sliders::bassSlide)
                 {
                     auto slider = std::make_unique<ParamSliderRotary> (param);
                     if (paramIdt == Sliders::melodyWaveshape)
-                        slider->addImage (ImageCache::getFromMemory (BinaryData::CookieMM1_png, BinaryData::CookieMM1_pngSize));
+                        slider->addImage ("CookieMM1");
                     else
-                        slider->addImage (ImageCache::getFromMemory (BinaryData::CookieMM2_png, BinaryData::CookieMM2_pngSize));
+                        slider->addImage ("CookieMM2");
                     sliders[paramIdt] = std::move (slider);
                 }
                 // density, step length, and root note are linearbarvertical
-                else if (Sliders::stepLength.toString() == param->getParameterID()
-                         || Sliders::rootNote.toString() == param->getParameterID()
-                         || Sliders::density.toString() == param->getParameterID())
+                else if (paramIdt == Sliders::stepLength || paramIdt == Sliders::rootNote || paramIdt == Sliders::density)
                 {
                     isLinearBarVerticalSlider = true;
                     auto slider               = std::make_unique<nlt::APVTSControl<nlt::Slider>> (param);
@@ -340,16 +353,16 @@ void EditorContainer::setupSliders()
                     switch (cookieAlternator++ % 4)
                     {
                         case 0:
-                            slider->addImage (ImageCache::getFromMemory (BinaryData::Cookie1_png, BinaryData::Cookie1_pngSize));
+                            slider->addImage ("Cookie1");
                             break;
                         case 1:
-                            slider->addImage (ImageCache::getFromMemory (BinaryData::Cookie2_png, BinaryData::Cookie2_pngSize));
+                            slider->addImage ("Cookie2");
                             break;
                         case 2:
-                            slider->addImage (ImageCache::getFromMemory (BinaryData::Cookie3_png, BinaryData::Cookie3_pngSize));
+                            slider->addImage ("Cookie3");
                             break;
                         case 3:
-                            slider->addImage (ImageCache::getFromMemory (BinaryData::Cookie4_png, BinaryData::Cookie4_pngSize));
+                            slider->addImage ("Cookie4");
                             break;
                     }
                     // mix it up for 2nd row
@@ -370,6 +383,44 @@ void EditorContainer::setupSliders()
     }
 }
 
+void EditorContainer::setupEnvelopeGroups()
+{
+    // automating several stages at once, or loading a preset, shouldn't show a half changed envelope, so each set of
+    // knobs moves together
+    for (auto* idts: { &Sliders::melodyEnvelopeIdts, &Sliders::bassEnvelopeIdts })
+    {
+        Array<RangedAudioParameter*>    parameters;
+        std::vector<ParamSliderRotary*> knobs;
+        for (auto& idt: *idts)
+        {
+            auto found = sliders.find (idt);
+            if (found == sliders.end())
+                break;
+            if (auto* knob = dynamic_cast<ParamSliderRotary*> (found->second.get()))
+            {
+                parameters.add (&knob->getParameter());
+                knobs.push_back (knob);
+            }
+        }
+
+        // the patch doesn't have this envelope, leave whatever knobs there are following their own parameters
+        if (knobs.size() != idts->size())
+            continue;
+
+        for (auto* knob: knobs)
+            knob->getAttachment().setFollowsParameter (false);
+
+        callbacks.addGroup (parameters,
+                            [knobs] (const std::vector<float>& values)
+                            {
+                                for (size_t i = 0; i < knobs.size(); ++i)
+                                    if (!approximatelyEqual (knobs[i]->getValue(), static_cast<double> (values[i])))
+                                        knobs[i]->getAttachment().setValue (values[i]);
+                            },
+                            [processor = _audioProcessor] { return processor->isSwitchingPreset(); });
+    }
+}
+
 void EditorContainer::setupSequencers()
 {
     auto parameters = rnboProcessor->getParameters();
@@ -405,48 +456,41 @@ void EditorContainer::setupSequencers()
     }
 
     sequenceEditActions.add (melodySequencer,
-                             [this] (juce::ChangeBroadcaster* broadcaster)
+                             [this, stepIn = RNBO::TAG (Inports::melodyStepIn)] (juce::ChangeBroadcaster* broadcaster)
                              {
                                  if (auto* sequencer = dynamic_cast<SequencerComponent*> (broadcaster))
                                  {
-                                     sendSequencerValues (*sequencer, "melodySequenceIn");
+                                     sendSequencerValues (*sequencer, stepIn);
                                  }
                              });
     sequenceEditActions.add (bassSequencer,
-                             [this] (juce::ChangeBroadcaster* broadcaster)
+                             [this, stepIn = RNBO::TAG (Inports::bassStepIn)] (juce::ChangeBroadcaster* broadcaster)
                              {
                                  if (auto* sequencer = dynamic_cast<SequencerComponent*> (broadcaster))
                                  {
-                                     sendSequencerValues (*sequencer, "bassSequenceIn");
+                                     sendSequencerValues (*sequencer, stepIn);
                                  }
                              });
     sequenceEditActions.add (kickSequencer,
-                             [this] (juce::ChangeBroadcaster* broadcaster)
+                             [this, stepIn = RNBO::TAG (Inports::kickStepIn)] (juce::ChangeBroadcaster* broadcaster)
                              {
                                  if (auto* sequencer = dynamic_cast<SequencerComponent*> (broadcaster))
                                  {
-                                     sendSequencerValues (*sequencer, "kickSequenceIn");
+                                     sendSequencerValues (*sequencer, stepIn);
                                  }
                              });
     sequenceEditActions.add (snareSequencer,
-                             [this] (juce::ChangeBroadcaster* broadcaster)
+                             [this, stepIn = RNBO::TAG (Inports::snareStepIn)] (juce::ChangeBroadcaster* broadcaster)
                              {
                                  if (auto* sequencer = dynamic_cast<SequencerComponent*> (broadcaster))
-                                     sendSequencerValues (*sequencer, "snareSequenceIn");
+                                     sendSequencerValues (*sequencer, stepIn);
                              });
     sequenceEditActions.add (hatSequencer,
-                             [this] (juce::ChangeBroadcaster* broadcaster)
+                             [this, stepIn = RNBO::TAG (Inports::hatStepIn)] (juce::ChangeBroadcaster* broadcaster)
                              {
                                  if (auto* sequencer = dynamic_cast<SequencerComponent*> (broadcaster))
-                                     sendSequencerValues (*sequencer, "hatSequenceIn");
+                                     sendSequencerValues (*sequencer, stepIn);
                              });
-
-    currentStepAction.setAction (
-        [this]()
-        {
-            seqStepIndicator.setCurrentStep (currentStep);
-        },
-        24.0f);
 }
 
 void EditorContainer::setupToggles()
@@ -459,26 +503,24 @@ void EditorContainer::setupToggles()
     {
         if (auto* param = dynamic_cast<RangedAudioParameter*> (parameter))
         {
-            for (auto& paramIdt: Toggles::allIdts)
+            auto paramIdt = ParameterTable::getIdentifier (*param);
+            if (ParameterTable::contains (Toggles::allIdts, paramIdt))
             {
-                if (paramIdt.toString() == param->getParameterID())
+                auto set = [this, &paramIdt] (auto& toggle)
                 {
-                    auto set = [this, &paramIdt] (auto& toggle)
-                    {
-                        toggle->setClickingTogglesState (true);
-                        toggle->setName (paramIdt.toString() + " toggle");
-                        addAndMakeVisible (toggle.get());
-                    };
-                    if (paramIdt == Toggles::run)
-                    {
-                        runToggle = std::make_unique<ParamToggle> (param);
-                        set (runToggle);
-                    }
-                    else if (paramIdt == Toggles::generateMelodyAlways)
-                    {
-                        infinityToggle = std::make_unique<ParamImageButton> (param);
-                        set (infinityToggle);
-                    }
+                    toggle->setClickingTogglesState (true);
+                    toggle->setName (paramIdt.toString() + " toggle");
+                    addAndMakeVisible (toggle.get());
+                };
+                if (paramIdt == Toggles::run)
+                {
+                    runToggle = std::make_unique<ParamToggle> (param);
+                    set (runToggle);
+                }
+                else if (paramIdt == Toggles::generateMelodyAlways)
+                {
+                    infinityToggle = std::make_unique<ParamImageButton> (param);
+                    set (infinityToggle);
                 }
             }
         }
@@ -486,8 +528,8 @@ void EditorContainer::setupToggles()
     runLabel.setFont (27.0f);
     addAndMakeVisible (runLabel);
 
-    auto imgOff = ImageCache::getFromMemory (BinaryData::MM1_Outline_png, BinaryData::MM1_Outline_pngSize);
-    auto imgOn  = ImageCache::getFromMemory (BinaryData::MM1_png, BinaryData::MM1_pngSize);
+    auto imgOff = Assets::getImage ("MM1_Outline");
+    auto imgOn  = Assets::getImage ("MM1");
     infinityToggle->setImages (false,
                                true,
                                true,
@@ -501,7 +543,7 @@ void EditorContainer::setupToggles()
                                1.0f,
                                Colours::transparentBlack);
 
-    imgOn  = ImageCache::getFromMemory (BinaryData::chiptog1_png, BinaryData::chiptog1_pngSize);
+    imgOn  = Assets::getImage ("chiptog1");
 
     auto seqTree = presetTree.getChildWithName(sequencerVisIdt);
     auto index = 0;
@@ -542,9 +584,9 @@ void EditorContainer::setupToggles()
 void EditorContainer::setupButtons()
 {
     size_t             chipAlternator = 0;
-    std::vector<Image> chipImages { ImageCache::getFromMemory (BinaryData::Chip1_png, BinaryData::Chip1_pngSize),
-                                    ImageCache::getFromMemory (BinaryData::Chip2_png, BinaryData::Chip2_pngSize),
-                                    ImageCache::getFromMemory (BinaryData::Chip3_png, BinaryData::Chip3_pngSize) };
+    std::vector<Image> chipImages { Assets::getImage ("Chip1"),
+                                    Assets::getImage ("Chip2"),
+                                    Assets::getImage ("Chip3") };
     for (auto& b: SeqButtons::genIdts)
     {
         auto& button = seqGenButtons[b] = std::make_unique<ImageButton>();
@@ -567,11 +609,7 @@ void EditorContainer::setupButtons()
 
         String           inportTag = "generate" + b.toString();
         RNBO::MessageTag generateInport { RNBO::TAG (inportTag.toRawUTF8()) };
-        button->onClick = [this, generateInport]()
-        {
-            static RNBO::MessageTag bang { RNBO::TAG ("") };
-            _rnboObject.sendMessage (generateInport, bang);
-        };
+        button->onClick = [this, generateInport]() { commandBus.sendBang (generateInport); };
         seqGenLabels[b] = std::make_unique<Label> ("seq button", "generate " + b.toString());
         seqGenLabels[b]->setFont (16.0f);
         addAndMakeVisible (*seqGenLabels[b]);
@@ -599,11 +637,7 @@ void EditorContainer::setupButtons()
 
         String           inportTag = b.toString() + "Seq";
         RNBO::MessageTag generateInport { RNBO::TAG (inportTag.toRawUTF8()) };
-        button->onClick = [this, generateInport]()
-        {
-            static RNBO::MessageTag bang { RNBO::TAG ("") };
-            _rnboObject.sendMessage (generateInport, bang);
-        };
+        button->onClick = [this, generateInport]() { commandBus.sendBang (generateInport); };
 
         seqGenLabels[b] =
             std::make_unique<Label> ("seq button", "clear " + b.toString().fromFirstOccurrenceOf ("clear", false, true));
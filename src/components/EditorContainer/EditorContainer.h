@@ -9,6 +9,7 @@
 #include "parameter-handling/APVTSControl.h"
 #include "components/PresetBar/PresetBar.h"
 #include "parameter-handling/ValueTreeToggleButton.h"
+#include "messaging/MessageRouter.h"
 
 using ParamSliderLinearVertical = nlt::APVTSControl<SliderMasked>;
 using ParamSliderRotary         = nlt::APVTSControl<SliderRotary>;
@@ -36,6 +37,7 @@ protected:
     CustomAudioProcessor*     _audioProcessor;
     RNBO::JuceAudioProcessor* rnboProcessor;
     RNBO::CoreObject&         _rnboObject;
+    CommandBus&               commandBus;
     ApplicationProperties&    appProperties;
     juce::ValueTree           presetTree;
     PresetBar                 presetBar;
@@ -49,6 +51,8 @@ protected:
     // these are in the order that they appear in the editor
     std::vector<SequencerComponent*> sequencers { &melodySequencer, &bassSequencer, &hatSequencer, &snareSequencer, &kickSequencer };
     SequencerStepIndicator    seqStepIndicator;
+    // drives every timed UI action from this display's refresh while the editor is showing
+    nlt::FrameScheduler::VBlankSource frameSource { this };
     ImageButton               aboutPanelButton;
     TextButton                zoomButton { "zoom" };
     float                     scale { 1.0f };
@@ -65,11 +69,14 @@ protected:
         snare,
         kick
     };
-    int                                    currentStep { 0 };
     juce::ValueTree                        pluginState;
+    // only for receiving outport messages, commands go through commandBus
     RNBO::ParameterEventInterfaceUniquePtr _parameterInterface;
-    nlt::TimerAction                       currentStepAction;
     nlt::ChangeListenerActions             sequenceEditActions;
+    nlt::TimerAction                       playheadAction;
+    MessageRouter                          outports;
+    // outport messages were dropped during a bounce, the sequencers need refreshing
+    bool                                   missedOutports { false };
     SharedResourcePointer<TooltipWindow>   tooltipWindow;
 
     std::map<Identifier, std::unique_ptr<ImageButton>> seqGenButtons;
@@ -90,13 +97,16 @@ protected:
     Image bgImage;
 
     void setupSliders();
+    void setupEnvelopeGroups();
     void setupSequencers();
+    void setupOutports();
+    void updatePlayhead();
     void setupToggles();
     void setupButtons();
     void setupTooltips();
     void setScale (float newScale);
 
-    void sendSequencerValues (SequencerComponent& seq, juce::StringRef inputTag);
+    void sendSequencerValues (SequencerComponent& seq, RNBO::MessageTag stepIn);
 
     void setSizeFromSequencers();
 
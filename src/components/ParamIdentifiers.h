@@ -47,6 +47,11 @@ inline static const std::vector<Identifier> globalControlIdts { stepLength, root
 inline static const std::vector<Identifier> bassIdts { bassLevel, bassOctave,  bassSlide,  bassAttack,
                                                        bassDecay, bassSustain, bassRelease };
 
+// the envelope stages in melodyIdts and bassIdts, each set is updated in the editor as one
+inline static const std::vector<Identifier> melodyEnvelopeIdts { melodyAttack, melodyDecay, melodySustain, melodyRelease };
+
+inline static const std::vector<Identifier> bassEnvelopeIdts { bassAttack, bassDecay, bassSustain, bassRelease };
+
 inline static const std::vector<Identifier> percIdts { kickLevel, snareLevel, hatLevel };
 
 } // namespace Sliders
@@ -85,3 +90,34 @@ inline static const std::vector<Identifier> genIdts { melody, bass, hat, snare,
 inline static const std::vector<Identifier> clearIdts { clearMelody, clearBass, clearKick, clearSnare, clearHat };
 
 } // namespace SeqButtons
+
+/** Tags of the patch's step inports, which take one step at a time, see SequenceWire */
+namespace Inports
+{
+inline constexpr const char* melodyStepIn = "melodyStepIn";
+inline constexpr const char* bassStepIn   = "bassStepIn";
+inline constexpr const char* kickStepIn   = "kickStepIn";
+inline constexpr const char* snareStepIn  = "snareStepIn";
+inline constexpr const char* hatStepIn    = "hatStepIn";
+
+} // namespace Inports
+
+/** Tags of the patch's outports, for MessageRouter */
+namespace Outports
+{
+inline constexpr const char* stepPosition      = "stepPosition";
+inline constexpr const char* melodySequenceOut = "melodySequenceOut";
+inline constexpr const char* bassSequenceOut   = "bassSequenceOut";
+inline constexpr const char* kickSequenceOut   = "kickSequenceOut";
+inline constexpr const char* snareSequenceOut  = "snareSequenceOut";
+inline constexpr const char* hatSequenceOut    = "hatSequenceOut";
+inline constexpr const char* melodyStepOut     = "melodyStepOut";
+inline constexpr const char* bassStepOut       = "bassStepOut";
+inline constexpr const char* kickStepOut       = "kickStepOut";
+inline constexpr const char* snareStepOut      = "snareStepOut";
+inline constexpr const char* hatStepOut        = "hatStepOut";
+
+inline constexpr const char* sequenceOuts[] { melodySequenceOut, bassSequenceOut, kickSequenceOut, snareSequenceOut, hatSequenceOut,
+                                              melodyStepOut,     bassStepOut,     kickStepOut,     snareStepOut,     hatStepOut };
+
+} // namespace Outports
@@ -0,0 +1,92 @@
+#pragma once
+#include "JuceHeader.h"
+#include "RNBO.h"
+#include <mutex>
+
+#if __has_include(<chippo_parameter_table.h>)
+#    include <chippo_parameter_table.h>
+#endif
+
+/**
+ * Maps the processor's parameters to the identifiers in ParamIdentifiers.h by index.
+ *
+ * With a generated table (see cmake/ChippoParameterTable.cmake) the identifiers are made once per
+ * process from the constexpr ids, and every lookup after that is an array index. Without one, or if the
+ * table doesn't match the processor, each lookup falls back to the parameter's ID string.
+ */
+namespace ParameterTable
+{
+
+namespace detail
+{
+    inline std::vector<juce::Identifier>& getProcessorIdentifiers()
+    {
+        static std::vector<juce::Identifier> identifiers;
+        return identifiers;
+    }
+} // namespace detail
+
+/**
+ * Works out which table entry each processor parameter is, from the RNBO index the adapter gave it.
+ * Call it from the processor's constructor, once the adapter has added its parameters. Only the first
+ * call does anything, every instance has the same parameters.
+ *
+ * Every parameter has to be in the table under its RNBO index with the same id. If any of them isn't,
+ * the export and the generated table are out of sync and the table isn't used at all, in release builds too.
+ */
+inline void bind (juce::AudioProcessor& processor, RNBO::CoreObject& rnboObject)
+{
+#ifdef CHIPPO_HAS_PARAMETER_TABLE
+    static std::once_flag once;
+    std::call_once (once,
+                    [&]
+                    {
+                        std::vector<juce::Identifier> ids;
+                        for (auto* parameter: processor.getParameters())
+                        {
+                            auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter);
+                            if (ranged == nullptr)
+                                return;
+
+                            auto paramId   = ranged->getParameterID();
+                            auto rnboIndex = rnboObject.getParameterIndexForID (paramId.toRawUTF8());
+                            auto info      = std::find_if (ChippoParameterTable::parameters,
+                                                      ChippoParameterTable::parameters + ChippoParameterTable::numParameters,
+                                                      [rnboIndex] (auto& i) { return i.rnboIndex == static_cast<int> (rnboIndex); });
+
+                            if (info == ChippoParameterTable::parameters + ChippoParameterTable::numParameters
+                                || paramId != info->id)
+                            {
+                                // the export and the generated table are out of sync, re-run cmake
+                                jassertfalse;
+                                return;
+                            }
+                            ids.push_back (info->id);
+                        }
+                        detail::getProcessorIdentifiers() = std::move (ids);
+                    });
+#else
+    juce::ignoreUnused (processor, rnboObject);
+#endif
+}
+
+/** Returns the identifier of a processor parameter */
+inline juce::Identifier getIdentifier (juce::AudioProcessorParameter& parameter)
+{
+    auto& ids   = detail::getProcessorIdentifiers();
+    auto  index = parameter.getParameterIndex();
+    if (juce::isPositiveAndBelow (index, static_cast<int> (ids.size())))
+        return ids[static_cast<size_t> (index)];
+
+    if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (&parameter))
+        return ranged->getParameterID();
+    return {};
+}
+
+/** Identifier comparisons are pointer comparisons, so this is cheap for the small groups in ParamIdentifiers.h */
+inline bool contains (const std::vector<juce::Identifier>& group, const juce::Identifier& id)
+{
+    return std::find (group.begin(), group.end(), id) != group.end();
+}
+
+} // namespace ParameterTable
@@ -8,6 +8,8 @@
 */
 
 #include "PresetBar.h"
+#include "state/PresetBank.h"
+#include "components/Assets.h"
 
 using namespace juce;
 
@@ -37,7 +39,8 @@ PresetBar::PresetBar (File _location, ValueTree pluginState)
     {
         PopupMenu pm;
 
-        populateMenu (pm, presetLocation);
+        presetIndex->populateMenu (pm, [this] (const File& file) { loadPresetInternal (file); });
+        presetIndex->refresh();
 
         pm.showMenuAsync (PopupMenu::Options().withTargetComponent (preset));
     };
@@ -108,7 +111,7 @@ PresetBar::PresetBar (File _location, ValueTree pluginState)
         button.onClick = [this, isUpButton]() { useIncDecButton (isUpButton); };
     };
 
-    auto upImage = ImageCache::getFromMemory (BinaryData::arrow_up_png, BinaryData::arrow_up_pngSize);
+    auto upImage = Assets::getImage ("arrow_up");
     upButton.setImages (false,
                         true,
                         false,
@@ -124,7 +127,7 @@ PresetBar::PresetBar (File _location, ValueTree pluginState)
     setupArrows (upButton, true);
     addAndMakeVisible (upButton);
 
-    auto downImage = ImageCache::getFromMemory (BinaryData::arrow_down_png, BinaryData::arrow_down_pngSize);
+    auto downImage = Assets::getImage ("arrow_down");
     downButton.setImages (false,
                           true,
                           false,
@@ -173,6 +176,8 @@ void PresetBar::savePreset (File file)
                 jassertfalse; // must set save function !
 
             currentFile.replaceWithData (block.getData(), block.getSize());
+            presetIndex->addPreset (currentFile);
+            prefetcher.invalidate (currentFile);
         }
     }
     else
@@ -181,65 +186,46 @@ void PresetBar::savePreset (File file)
 
 void PresetBar::loadPresetInternal (const juce::File& file)
 {
-    MemoryBlock mem;
-    file.loadFileAsData (mem);
-    if (this->loadPresetFn != nullptr)
-        this->loadPresetFn (mem);
+    auto prepared = loadPreparedFn != nullptr ? prefetcher.take (file) : nullptr;
+    if (prepared != nullptr)
+    {
+        loadPreparedFn (std::move (prepared));
+    }
     else
-        jassertfalse; // need to set the load function!
+    {
+        MemoryBlock mem;
+        PresetBank::loadPreset (file, mem);
+        if (this->loadPresetFn != nullptr)
+            this->loadPresetFn (mem);
+        else
+            jassertfalse; // need to set the load function!
+    }
 
     this->preset.setButtonText (file.getFileNameWithoutExtension());
     this->currentFile = file;
+
+    prefetchNeighbours (file);
 }
 
-void PresetBar::populateMenu (PopupMenu& pm, File folder)
+void PresetBar::prefetchNeighbours (const File& file)
 {
-    auto folders = folder.findChildFiles (File::TypesOfFileToFind::findDirectories, false);
-    for (auto i = 0; i < folders.size(); ++i)
-    {
-        PopupMenu subPm;
-        populateMenu (subPm, folders[i]);
-        pm.addSubMenu (folders[i].getFileName(), subPm);
-    }
-    auto files = folder.findChildFiles (File::TypesOfFileToFind::findFiles, false, "*." + fileExtension);
-    for (auto i = 0; i < files.size(); ++i)
-    {
-        pm.addItem (files[i].getFileNameWithoutExtension(), [this, file = files[i]]() { loadPresetInternal (file); });
-    }
-    pm.addSeparator();
-    pm.addItem ("open location", [folder]() { folder.revealToUser(); });
+    if (loadPreparedFn == nullptr)
+        return;
+
+    // the next ones first, that's the way people mostly step
+    Array<File> files;
+    for (auto delta: { 1, -1, 2, -2 })
+        files.addIfNotAlreadyThere (presetIndex->getPresetNextTo (file, delta));
+    files.removeFirstMatchingValue (File());
+    files.removeFirstMatchingValue (file);
+    prefetcher.prefetch (files);
 }
 
 void PresetBar::useIncDecButton (bool isUpButton)
 {
-    if (!currentFile.exists())
-    {
-        auto files = presetLocation.findChildFiles (File::TypesOfFileToFind::findFiles, false, "*." + fileExtension);
-        if (files.isEmpty())
-            return;
-
-        auto file = files[0];
+    auto file = presetIndex->getPresetNextTo (currentFile, isUpButton ? -1 : 1);
+    if (file != File())
         loadPresetInternal (file);
-        return;
-    }
-
-    auto files =
-        currentFile.getParentDirectory().findChildFiles (File::TypesOfFileToFind::findFiles, false, "*." + fileExtension);
-
-    if (files.isEmpty())
-        return;
-
-    for (auto i = 0; i < files.size(); ++i)
-    {
-        if (currentFile == files[i])
-        {
-            auto newIndex = i + (isUpButton ? -1 : 1);
-            if (newIndex < 0)
-                newIndex += files.size();
-            loadPresetInternal (files[newIndex % files.size()]);
-            break;
-        }
-    }
 }
 
 void PresetBar::setPresetNameAndFile (const String& name, const File& file)
@@ -266,8 +252,11 @@ void PresetBar::setupPresetTree()
                      [this] (const var& filePath)
                      {
                          auto f = File (filePath.toString());
-                         if (f.existsAsFile())
+                         if (f.existsAsFile() || PresetBank::findBankFor (f) != File())
+                         {
                              currentFile = f;
+                             prefetchNeighbours (f);
+                         }
                      });
     vtCallbacks.add (presetTree,
                      currentPresetNameIdt,
@@ -10,12 +10,20 @@
 #pragma once
 #include "../../utilities/FileChooserHolder.h"
 #include "../../utilities/ValueTreeCallback.h"
+#include "PresetIndex.h"
+#include "PresetPrefetcher.h"
 
 struct PresetBar : public juce::Component, public FileChooserHolder
 {
     PresetBar (juce::File _location, juce::ValueTree pluginState);
 
-    void setSaveLocation (File location) { presetLocation = location; }
+    /** Sets where presets are kept and their extension together, so the shared index is only pointed at it once */
+    void setSaveLocation (File location, const String& extension)
+    {
+        presetLocation = location;
+        fileExtension  = extension;
+        presetIndex->setRoot (presetLocation, fileExtension);
+    }
 
     template <typename Fn>
     void setSaveFn (Fn&& fn)
@@ -29,7 +37,12 @@ struct PresetBar : public juce::Component, public FileChooserHolder
         loadPresetFn = NLT_FWD (fn);
     }
 
-    void setFileExtension (const String& extension) { fileExtension = extension; }
+    /** Optional. When set, neighbouring presets are decoded in the background and applied with this instead */
+    template <typename Fn>
+    void setLoadPreparedFn (Fn&& fn)
+    {
+        loadPreparedFn = NLT_FWD (fn);
+    }
 
     void resized() override;
 
@@ -48,8 +61,10 @@ private:
     ValueTreeCallbacks                 vtCallbacks;
     ImageButton                        upButton;
     ImageButton                        downButton;
+    SharedResourcePointer<PresetIndex> presetIndex;
+    PresetPrefetcher                   prefetcher;
 
-    void populateMenu (PopupMenu& pm, File folder);
+    std::function<void (std::unique_ptr<PreparedState>)> loadPreparedFn { nullptr };
 
     void savePreset (File file);
 
@@ -61,5 +76,7 @@ private:
 
     void loadPresetInternal (const File&);
 
+    void prefetchNeighbours (const File& file);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBar)
 };
@@ -0,0 +1,549 @@
+/*
+  ==============================================================================
+
+    PresetIndex.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetIndex.h"
+#include "state/PresetBank.h"
+
+#if JUCE_LINUX
+#    include <poll.h>
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#endif
+
+using namespace juce;
+
+PresetIndex::PresetIndex()
+    : Thread ("Chippo preset index")
+{
+}
+
+PresetIndex::~PresetIndex()
+{
+    stopThread (pollIntervalMs * 20);
+}
+
+void PresetIndex::setRoot (const File& folder, const String& extension)
+{
+    // every editor sets it, only the first one (or a real change) should cost a scan
+    auto newExtension = extension.trimCharactersAtStart (".");
+    if (folder == root && newExtension == fileExtension && (isThreadRunning() || !folder.isDirectory()))
+        return;
+
+    stopThread (pollIntervalMs * 20);
+
+    {
+        const ScopedLock sl (lock);
+        folders.clear();
+    }
+    isReady       = false;
+    root          = folder;
+    fileExtension = newExtension;
+
+    if (root.isDirectory())
+        startThread (Thread::Priority::low);
+}
+
+void PresetIndex::refresh()
+{
+    if (!isWatching)
+        notify();
+}
+
+void PresetIndex::addPreset (const File& file)
+{
+    if (!file.isAChildOf (root) || !file.hasFileExtension (fileExtension))
+        return;
+
+    const ScopedLock sl (lock);
+    auto& folder = folders[keyFor (file.getParentDirectory())];
+    if (folder.presets.addIfNotAlreadyThere (file.getFileNameWithoutExtension()))
+        folder.presets.sortNatural();
+}
+
+//==============================================================================
+
+void PresetIndex::populateMenu (PopupMenu& pm, const std::function<void (const File&)>& onSelect) const
+{
+    if (!isReady)
+    {
+        populateFromDisk (pm, root, onSelect);
+        return;
+    }
+
+    const ScopedLock sl (lock);
+    populateFolder (pm, {}, onSelect);
+}
+
+void PresetIndex::populateFolder (PopupMenu&                              pm,
+                                  const String&                           key,
+                                  const std::function<void (const File&)>& onSelect) const
+{
+    auto found = folders.find (key);
+    if (found != folders.end())
+    {
+        for (auto& sub: found->second.subfolders)
+        {
+            PopupMenu subPm;
+            populateFolder (subPm, childKey (key, sub), onSelect);
+            pm.addSubMenu (sub.upToLastOccurrenceOf ("." + String (PresetBank::fileExtension), false, false), subPm);
+        }
+        for (auto& preset: found->second.presets)
+            pm.addItem (preset, [onSelect, file = fileFor (key, preset)]() { onSelect (file); });
+    }
+    pm.addSeparator();
+    pm.addItem ("open location", [folder = root.getChildFile (key)]() { folder.revealToUser(); });
+}
+
+void PresetIndex::populateFromDisk (PopupMenu&                              pm,
+                                    const File&                             dir,
+                                    const std::function<void (const File&)>& onSelect) const
+{
+    auto subfolders = dir.findChildFiles (File::findDirectories, false);
+    subfolders.sort();
+    for (auto& sub: subfolders)
+    {
+        PopupMenu subPm;
+        populateFromDisk (subPm, sub, onSelect);
+        pm.addSubMenu (sub.getFileName(), subPm);
+    }
+
+    for (auto& file: getPresetsOnDisk (dir))
+        pm.addItem (file.getFileNameWithoutExtension(), [onSelect, file]() { onSelect (file); });
+
+    pm.addSeparator();
+    pm.addItem ("open location", [dir]() { dir.revealToUser(); });
+}
+
+Array<File> PresetIndex::getPresetsOnDisk (const File& dir) const
+{
+    auto files = dir.findChildFiles (File::findFiles, false, "*." + fileExtension);
+    files.sort();
+    return files;
+}
+
+File PresetIndex::getPresetNextToOnDisk (const File& file, int delta) const
+{
+    if (!file.existsAsFile())
+    {
+        auto files = getPresetsOnDisk (root);
+        return file.exists() || files.isEmpty() ? File() : files[0];
+    }
+
+    auto files = getPresetsOnDisk (file.getParentDirectory());
+    auto index = files.indexOf (file);
+    if (index < 0)
+        return {};
+
+    auto newIndex = (index + delta) % files.size();
+    if (newIndex < 0)
+        newIndex += files.size();
+    return files[newIndex];
+}
+
+File PresetIndex::getPresetNextTo (const File& file, int delta) const
+{
+    if (!isReady)
+        return getPresetNextToOnDisk (file, delta);
+
+    const ScopedLock sl (lock);
+
+    auto key   = keyFor (file.getParentDirectory());
+    auto found = folders.find (key);
+    auto index = found != folders.end() ? found->second.presets.indexOf (file.getFileNameWithoutExtension()) : -1;
+    if (index < 0)
+    {
+        // presets inside banks aren't on disk, but anything else we don't know about isn't either
+        if (file.exists())
+            return {};
+
+        auto rootFolder = folders.find ({});
+        if (rootFolder == folders.end() || rootFolder->second.presets.isEmpty())
+            return {};
+        return fileFor ({}, rootFolder->second.presets[0]);
+    }
+
+    auto& presets = found->second.presets;
+
+    auto newIndex = (index + delta) % presets.size();
+    if (newIndex < 0)
+        newIndex += presets.size();
+    return fileFor (key, presets[newIndex]);
+}
+
+File PresetIndex::fileFor (const String& key, const String& preset) const
+{
+    return root.getChildFile (key).getChildFile (preset + "." + fileExtension);
+}
+
+String PresetIndex::keyFor (const File& dir) const
+{
+    return dir == root ? String() : dir.getRelativePathFrom (root);
+}
+
+String PresetIndex::childKey (const String& parentKey, const String& name)
+{
+    return parentKey.isEmpty() ? name : parentKey + File::getSeparatorString() + name;
+}
+
+String PresetIndex::parentKey (const String& key)
+{
+    auto separator = key.lastIndexOf (File::getSeparatorString());
+    return separator < 0 ? String() : key.substring (0, separator);
+}
+
+//==============================================================================
+
+void PresetIndex::run()
+{
+    if (loadCache())
+        isReady = true;
+
+#if JUCE_LINUX
+    inotifyFd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+#endif
+
+    rescan();
+
+    if (inotifyFd >= 0)
+    {
+        isWatching = true;
+        watchEvents();
+        isWatching = false;
+#if JUCE_LINUX
+        close (inotifyFd);
+#endif
+        inotifyFd = -1;
+        watches.clear();
+        return;
+    }
+
+    while (!threadShouldExit())
+    {
+        wait (-1);
+        if (!threadShouldExit())
+            rescan();
+    }
+}
+
+void PresetIndex::rescan()
+{
+    // existing watches are kept, watching an already watched folder just hands back the same descriptor
+    Folders scanned;
+    if (!scanFolder (root, {}, scanned))
+        return;
+
+    {
+        const ScopedLock sl (lock);
+        folders.swap (scanned);
+    }
+    isReady = true;
+    saveCache();
+}
+
+bool PresetIndex::scanFolder (const File& dir, const String& key, Folders& dest)
+{
+#if JUCE_LINUX
+    // watch before listing, so nothing created in between is missed. Adding twice is harmless
+    if (inotifyFd >= 0)
+    {
+        auto wd = inotify_add_watch (inotifyFd,
+                                     dir.getFullPathName().toRawUTF8(),
+                                     IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR);
+        if (wd >= 0)
+            watches[wd] = key;
+    }
+#endif
+
+    auto& folder = dest[key];
+    for (const auto& entry: RangedDirectoryIterator (dir, false, "*", File::findFilesAndDirectories))
+    {
+        if (threadShouldExit())
+            return false;
+
+        auto file = entry.getFile();
+        if (entry.isDirectory())
+        {
+            folder.subfolders.add (file.getFileName());
+            if (!scanFolder (file, childKey (key, file.getFileName()), dest))
+                return false;
+        }
+        else if (file.hasFileExtension (fileExtension))
+        {
+            folder.presets.add (file.getFileNameWithoutExtension());
+        }
+        else if (file.hasFileExtension (PresetBank::fileExtension))
+        {
+            folder.subfolders.add (file.getFileName());
+            scanBank (file, childKey (key, file.getFileName()), dest);
+        }
+    }
+
+    folder.subfolders.sortNatural();
+    folder.presets.sortNatural();
+    return true;
+}
+
+void PresetIndex::scanBank (const File& bankFile, const String& key, Folders& dest)
+{
+    auto bank = PresetBank::open (bankFile);
+    dest[key].bank = bank;
+    if (bank == nullptr)
+        return;
+
+    // bank names are already in menu order, only the folders they create need sorting
+    std::set<String> foldersAdded;
+    for (auto i = 0; i < bank->getNumPresets(); ++i)
+    {
+        auto path = StringArray::fromTokens (bank->getName (i), "/", {});
+        auto k    = key;
+        for (auto p = 0; p < path.size() - 1; ++p)
+        {
+            if (dest[k].subfolders.addIfNotAlreadyThere (path[p]))
+                foldersAdded.insert (k);
+            k = childKey (k, path[p]);
+        }
+        dest[k].presets.add (path[path.size() - 1]);
+    }
+
+    for (auto& k: foldersAdded)
+        dest[k].subfolders.sortNatural();
+}
+
+void PresetIndex::watchEvents()
+{
+#if JUCE_LINUX
+    alignas (inotify_event) char buffer[4096];
+    uint32                       lastChange = 0;
+
+    while (!threadShouldExit())
+    {
+        pollfd pfd { inotifyFd, POLLIN, 0 };
+        if (poll (&pfd, 1, pollIntervalMs) > 0 && (pfd.revents & POLLIN) != 0)
+        {
+            ssize_t length;
+            while ((length = read (inotifyFd, buffer, sizeof (buffer))) > 0)
+            {
+                for (auto* p = buffer; p < buffer + length;)
+                {
+                    auto* event = reinterpret_cast<const inotify_event*> (p);
+                    if ((event->mask & IN_Q_OVERFLOW) != 0)
+                        rescan();
+                    else if ((event->mask & IN_IGNORED) != 0)
+                        watches.erase (event->wd);
+                    else if (event->len > 0)
+                        handleEvent (event->wd, event->mask, String::fromUTF8 (event->name));
+
+                    p += sizeof (inotify_event) + event->len;
+                }
+                lastChange = Time::getMillisecondCounter();
+            }
+        }
+
+        // a sync client can drop thousands of files at once, so only save once things settle
+        if (lastChange != 0 && Time::getMillisecondCounter() - lastChange > persistDelayMs)
+        {
+            saveCache();
+            lastChange = 0;
+        }
+    }
+
+    if (lastChange != 0)
+        saveCache();
+#endif
+}
+
+void PresetIndex::handleEvent (int wd, uint32 mask, const String& name)
+{
+#if JUCE_LINUX
+    auto watch = watches.find (wd);
+    if (watch == watches.end())
+        return;
+
+    auto& parent  = watch->second;
+    auto  key     = childKey (parent, name);
+    auto  file    = root.getChildFile (key);
+    auto  added   = (mask & (IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE)) != 0;
+    auto  removed = (mask & (IN_DELETE | IN_MOVED_FROM)) != 0;
+
+    if ((mask & IN_ISDIR) != 0)
+    {
+        if (added)
+        {
+            Folders scanned;
+            scanFolder (file, key, scanned);
+            addScanned (parent, name, scanned);
+        }
+        else if (removed)
+        {
+            unwatch (key);
+            removeFolder (key);
+        }
+        return;
+    }
+
+    if (file.hasFileExtension (PresetBank::fileExtension))
+    {
+        // a bank copied in shows up empty on create, it's read again once the writer closes it
+        removeFolder (key);
+        if (added)
+        {
+            Folders scanned;
+            scanBank (file, key, scanned);
+            addScanned (parent, name, scanned);
+        }
+        return;
+    }
+
+    if (!file.hasFileExtension (fileExtension))
+        return;
+
+    auto preset = file.getFileNameWithoutExtension();
+
+    const ScopedLock sl (lock);
+    auto&            presets = folders[parent].presets;
+    if (added && presets.addIfNotAlreadyThere (preset))
+        presets.sortNatural();
+    else if (removed)
+        presets.removeString (preset);
+#else
+    ignoreUnused (wd, mask, name);
+#endif
+}
+
+void PresetIndex::addScanned (const String& parent, const String& name, Folders& scanned)
+{
+    const ScopedLock sl (lock);
+    for (auto& [k, folder]: scanned)
+        folders[k] = std::move (folder);
+
+    auto& subfolders = folders[parent].subfolders;
+    if (subfolders.addIfNotAlreadyThere (name))
+        subfolders.sortNatural();
+}
+
+void PresetIndex::removeFolder (const String& key)
+{
+    auto prefix = key + File::getSeparatorString();
+
+    const ScopedLock sl (lock);
+    for (auto it = folders.begin(); it != folders.end();)
+    {
+        if (it->first == key || it->first.startsWith (prefix))
+            it = folders.erase (it);
+        else
+            ++it;
+    }
+    folders[parentKey (key)].subfolders.removeString (key.fromLastOccurrenceOf (File::getSeparatorString(), false, false));
+}
+
+void PresetIndex::unwatch (const String& key)
+{
+    // a folder moved out of the tree keeps its watches, so drop them. Deleted folders clean up after themselves
+    auto prefix = key + File::getSeparatorString();
+    for (auto it = watches.begin(); it != watches.end();)
+    {
+        if (it->second == key || it->second.startsWith (prefix))
+        {
+#if JUCE_LINUX
+            inotify_rm_watch (inotifyFd, it->first);
+#endif
+            it = watches.erase (it);
+        }
+        else
+            ++it;
+    }
+}
+
+//==============================================================================
+
+File PresetIndex::getCacheFile() const
+{
+    auto dir = File::getSpecialLocation (File::userApplicationDataDirectory);
+#if JUCE_MAC
+    dir = dir.getChildFile ("Application Support");
+#endif
+    return dir.getChildFile ("Chippo").getChildFile ("PresetIndex.cache");
+}
+
+bool PresetIndex::loadCache()
+{
+    FileInputStream in (getCacheFile());
+    if (!in.openedOk() || in.readInt() != cacheMagic || in.readInt() != cacheVersion)
+        return false;
+
+    if (in.readString() != root.getFullPathName() || in.readString() != fileExtension)
+        return false;
+
+    // the counts come from the file, so check they fit in what's left of it before trusting them. Every string takes
+    // at least a byte (its terminator), and every folder at least three (its key and two counts)
+    auto fits = [&in] (int count, int minBytesEach)
+    { return count >= 0 && static_cast<int64> (count) * minBytesEach <= in.getNumBytesRemaining(); };
+
+    Folders loaded;
+    auto    numFolders = in.readCompressedInt();
+    if (!fits (numFolders, 3))
+        return false;
+
+    for (auto i = 0; i < numFolders; ++i)
+    {
+        if (in.isExhausted())
+            return false;
+
+        auto& folder = loaded[in.readString()];
+        for (auto* list: { &folder.subfolders, &folder.presets })
+        {
+            auto size = in.readCompressedInt();
+            if (!fits (size, 1))
+                return false;
+
+            list->ensureStorageAllocated (size);
+            for (auto j = 0; j < size; ++j)
+                list->add (in.readString());
+        }
+    }
+
+    const ScopedLock sl (lock);
+    folders.swap (loaded);
+    return true;
+}
+
+void PresetIndex::saveCache()
+{
+    Folders snapshot;
+    {
+        const ScopedLock sl (lock);
+        snapshot = folders;
+    }
+
+    auto cacheFile = getCacheFile();
+    cacheFile.getParentDirectory().createDirectory();
+
+    TemporaryFile temp (cacheFile);
+    {
+        FileOutputStream out (temp.getFile());
+        if (!out.openedOk())
+            return;
+
+        out.writeInt (cacheMagic);
+        out.writeInt (cacheVersion);
+        out.writeString (root.getFullPathName());
+        out.writeString (fileExtension);
+        out.writeCompressedInt (static_cast<int> (snapshot.size()));
+        for (auto& [key, folder]: snapshot)
+        {
+            out.writeString (key);
+            for (auto* list: { &folder.subfolders, &folder.presets })
+            {
+                out.writeCompressedInt (list->size());
+                for (auto& s: *list)
+                    out.writeString (s);
+            }
+        }
+    }
+    temp.overwriteTargetFileWithTemporary();
+}
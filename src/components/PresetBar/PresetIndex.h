@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    PresetIndex.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "JuceHeader.h"
+
+struct PresetBank;
+
+/**
+ * An in-memory copy of the preset folder tree, so opening the preset menu or stepping through presets
+ * never has to touch the disk. Preset banks in the tree show up as folders.
+ *
+ * The index is built on a background thread and saved next to the app properties, so the next session
+ * starts with the last known tree while the folder is rescanned. On Linux every folder is watched with
+ * inotify and the index is patched as files come and go. Elsewhere it's rescanned whenever refresh()
+ * is called, which PresetBar does each time the menu is opened.
+ *
+ * There's one index per process, shared by every editor through a juce::SharedResourcePointer, so
+ * opening more editors doesn't start more scans, watches or cache writers. Until the first scan (or the
+ * cache) is in, the menu and next/prev fall back to listing the folder on disk.
+ */
+struct PresetIndex : private juce::Thread
+{
+    PresetIndex();
+    ~PresetIndex() override;
+
+    /** Points the index at a folder and starts building it in the background */
+    void setRoot (const juce::File& folder, const juce::String& extension);
+
+    /** Adds the folders and presets to the menu, mirroring the folder tree */
+    void populateMenu (juce::PopupMenu& pm, const std::function<void (const juce::File&)>& onSelect) const;
+
+    /**
+     * Returns the preset delta steps away from file in the same folder, wrapping around at either end.
+     * If file doesn't exist this is the first preset in the root folder. Returns {} if there's nothing to step to.
+     */
+    juce::File getPresetNextTo (const juce::File& file, int delta) const;
+
+    /** Lets the index know about a preset we've just written, without waiting for the folder to be rescanned */
+    void addPreset (const juce::File& file);
+
+    /** Rescans in the background, unless the folder is already being watched */
+    void refresh();
+
+private:
+    struct Folder
+    {
+        juce::StringArray subfolders;
+        /** names without the extension */
+        juce::StringArray presets;
+        // for a bank, keeps it mapped while it's in the index so loading its presets doesn't map it again
+        std::shared_ptr<const PresetBank> bank;
+    };
+    using Folders = std::map<juce::String, Folder>;
+
+    static constexpr int          cacheMagic     = 0x58444950; // "PIDX"
+    static constexpr int          cacheVersion   = 1;
+    static constexpr int          pollIntervalMs = 100;
+    static constexpr juce::uint32 persistDelayMs = 2000;
+
+    juce::File   root;
+    juce::String fileExtension;
+
+    juce::CriticalSection lock;
+    Folders               folders;
+    std::atomic<bool>     isReady { false };
+    std::atomic<bool>     isWatching { false };
+
+    // only touched by the background thread
+    int                         inotifyFd { -1 };
+    std::map<int, juce::String> watches;
+
+    void run() override;
+
+    void rescan();
+    bool scanFolder (const juce::File& dir, const juce::String& key, Folders& dest);
+    void scanBank (const juce::File& bankFile, const juce::String& key, Folders& dest);
+    void watchEvents();
+    void handleEvent (int wd, juce::uint32 mask, const juce::String& name);
+    void addScanned (const juce::String& parent, const juce::String& name, Folders& scanned);
+    void removeFolder (const juce::String& key);
+    void unwatch (const juce::String& key);
+
+    void populateFolder (juce::PopupMenu& pm,
+                         const juce::String& key,
+                         const std::function<void (const juce::File&)>& onSelect) const;
+    void populateFromDisk (juce::PopupMenu& pm,
+                           const juce::File& dir,
+                           const std::function<void (const juce::File&)>& onSelect) const;
+    juce::File getPresetNextToOnDisk (const juce::File& file, int delta) const;
+    juce::Array<juce::File> getPresetsOnDisk (const juce::File& dir) const;
+
+    juce::File  fileFor (const juce::String& key, const juce::String& preset) const;
+    juce::String keyFor (const juce::File& dir) const;
+
+    static juce::String childKey (const juce::String& parentKey, const juce::String& name);
+    static juce::String parentKey (const juce::String& key);
+
+    juce::File getCacheFile() const;
+    bool       loadCache();
+    void       saveCache();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetIndex)
+};
@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    PresetPrefetcher.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetPrefetcher.h"
+#include "state/PresetBank.h"
+
+using namespace juce;
+
+PresetPrefetcher::PresetPrefetcher (int capacityToUse)
+    : Thread ("Chippo preset prefetch")
+    , capacity (jmax (1, capacityToUse))
+{
+    cache.reserve (static_cast<size_t> (capacity) + 1);
+    startThread (Thread::Priority::low);
+}
+
+PresetPrefetcher::~PresetPrefetcher()
+{
+    stopThread (1000);
+}
+
+void PresetPrefetcher::prefetch (const Array<File>& files)
+{
+    {
+        const ScopedLock sl (lock);
+        wanted = files;
+        wanted.removeRange (capacity, wanted.size());
+    }
+    notify();
+}
+
+std::unique_ptr<PreparedState> PresetPrefetcher::take (const File& file)
+{
+    const ScopedLock sl (lock);
+    for (auto it = cache.begin(); it != cache.end(); ++it)
+    {
+        if (it->file == file)
+        {
+            auto state = std::move (it->state);
+            cache.erase (it);
+            return state;
+        }
+    }
+    return nullptr;
+}
+
+void PresetPrefetcher::invalidate (const File& file)
+{
+    const ScopedLock sl (lock);
+    cache.erase (std::remove_if (cache.begin(), cache.end(), [&file] (const Entry& e) { return e.file == file; }),
+                 cache.end());
+}
+
+bool PresetPrefetcher::isCached (const File& file) const
+{
+    for (auto& e: cache)
+        if (e.file == file)
+            return true;
+    return false;
+}
+
+void PresetPrefetcher::run()
+{
+    while (!threadShouldExit())
+    {
+        wait (-1);
+
+        while (!threadShouldExit())
+        {
+            File next;
+            {
+                const ScopedLock sl (lock);
+                for (auto& f: wanted)
+                {
+                    if (!isCached (f))
+                    {
+                        next = f;
+                        break;
+                    }
+                }
+            }
+            if (next == File())
+                break;
+
+            MemoryBlock data;
+            auto        state = PresetBank::loadPreset (next, data) ? PreparedState::fromData (data.getData(), data.getSize())
+                                                                    : nullptr;
+
+            const ScopedLock sl (lock);
+            // drop it if it stopped being wanted while we were reading it
+            if (!wanted.contains (next))
+                continue;
+            if (state == nullptr)
+            {
+                // unreadable, don't keep retrying it
+                wanted.removeFirstMatchingValue (next);
+                continue;
+            }
+
+            cache.insert (cache.begin(), { next, std::move (state) });
+
+            // evict anything no longer wanted first, then the least recently used
+            for (auto i = (int) cache.size() - 1; i >= 0 && (int) cache.size() > capacity; --i)
+                if (!wanted.contains (cache[(size_t) i].file))
+                    cache.erase (cache.begin() + i);
+            if ((int) cache.size() > capacity)
+                cache.erase (cache.begin() + capacity, cache.end());
+        }
+    }
+}
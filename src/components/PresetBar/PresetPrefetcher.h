@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    PresetPrefetcher.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "JuceHeader.h"
+#include "state/PresetSwitcher.h"
+
+/**
+ * A small LRU of presets that have already been read and decoded, so stepping to a neighbouring
+ * preset only has to apply it.
+ *
+ * prefetch() is given the files worth having ready, and a background thread reads and decodes any
+ * that aren't cached yet. take() hands a decoded state over and drops it from the cache, since
+ * applying it consumes it. Anything we write ourselves should be invalidate()d.
+ */
+struct PresetPrefetcher : private juce::Thread
+{
+    explicit PresetPrefetcher (int capacity = 4);
+    ~PresetPrefetcher() override;
+
+    /** Replaces the list of files to have ready, most wanted first */
+    void prefetch (const juce::Array<juce::File>& files);
+
+    /** Returns the decoded state for file, or nullptr if it isn't ready */
+    std::unique_ptr<PreparedState> take (const juce::File& file);
+
+    void invalidate (const juce::File& file);
+
+private:
+    struct Entry
+    {
+        juce::File                     file;
+        std::unique_ptr<PreparedState> state;
+    };
+
+    const int               capacity;
+    juce::CriticalSection   lock;
+    /** most recently used at the front */
+    std::vector<Entry>      cache;
+    juce::Array<juce::File> wanted;
+
+    void run() override;
+    bool isCached (const juce::File& file) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetPrefetcher)
+};
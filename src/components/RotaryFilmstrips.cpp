@@ -0,0 +1,107 @@
+#include "RotaryFilmstrips.h"
+
+using namespace juce;
+
+const Image& RotaryFilmstrips::Strip::getFrame (float normalisedValue) const noexcept
+{
+    auto index = roundToInt (jlimit (0.0f, 1.0f, normalisedValue) * static_cast<float> (numFrames - 1));
+    return frames[static_cast<size_t> (index)];
+}
+
+std::shared_ptr<const RotaryFilmstrips::Strip> RotaryFilmstrips::get (const Image& image,
+                                                                      int          width,
+                                                                      int          height,
+                                                                      float        scale,
+                                                                      Component&   component)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    // knobs sharing an image loaded from the ImageCache share its pixel data
+    Key key { image.getPixelData(), width, height, scale };
+    if (auto existing = strips[key].lock())
+    {
+        // a strip that's just become ready still has its repaint on the way, which will pick this one up too
+        if (!existing->isReady())
+            existing->waiting.emplace_back (&component);
+        return existing;
+    }
+
+    for (auto it = strips.begin(); it != strips.end();)
+        it = it->second.expired() ? strips.erase (it) : std::next (it);
+
+    auto strip  = std::make_shared<Strip>();
+    strips[key] = strip;
+    strip->waiting.emplace_back (&component);
+
+    // native images aren't safe to draw from off the message thread on every platform, render from a software copy
+    auto source = SoftwareImageType().convert (image);
+
+    // the job only holds on weakly, so strips nobody is using any more are dropped rather than finished
+    pool.addJob ([weak = std::weak_ptr<Strip> (strip), source, width, height, scale] (int)
+                 { render (weak, source, width, height, scale); });
+    return strip;
+}
+
+AffineTransform RotaryFilmstrips::getTransform (const Image& image, float width, float height, float angle)
+{
+    auto imgW = static_cast<float> (image.getWidth());
+    auto imgH = static_cast<float> (image.getHeight());
+
+    auto scaleFactor = jmin (width / imgW, height / imgH);
+
+    auto scaledW = imgW * scaleFactor;
+    auto scaledH = imgH * scaleFactor;
+
+    auto drawX = (width - scaledW) * 0.5f;
+    auto drawY = (height - scaledH) * 0.5f;
+
+    auto pivotX = drawX + scaledW * 0.5f;
+    auto pivotY = drawY + scaledH * 0.5f;
+
+    return AffineTransform::scale (scaleFactor).translated (drawX, drawY).rotated (angle, pivotX, pivotY);
+}
+
+void RotaryFilmstrips::render (std::weak_ptr<Strip> strip, Image image, int width, int height, float scale)
+{
+    auto pixelW = jmax (1, roundToInt (static_cast<float> (width) * scale));
+    auto pixelH = jmax (1, roundToInt (static_cast<float> (height) * scale));
+
+    std::vector<Image> frames;
+    frames.reserve (numFrames);
+    for (auto i = 0; i < numFrames; ++i)
+    {
+        if (strip.expired())
+            return;
+
+        auto angle = getAngle (static_cast<float> (i) / static_cast<float> (numFrames - 1));
+
+        Image    frame (Image::ARGB, pixelW, pixelH, true, SoftwareImageType());
+        Graphics g (frame);
+        g.addTransform (AffineTransform::scale (static_cast<float> (pixelW) / static_cast<float> (width),
+                                                static_cast<float> (pixelH) / static_cast<float> (height)));
+        g.setImageResamplingQuality (Graphics::highResamplingQuality);
+        g.drawImageTransformed (image, getTransform (image, static_cast<float> (width), static_cast<float> (height), angle));
+        frames.push_back (std::move (frame));
+    }
+
+    if (auto s = strip.lock())
+    {
+        s->frames = std::move (frames);
+        s->ready.store (true, std::memory_order_release);
+    }
+
+    // the knobs only paint the strip once they're repainted, and an idle knob won't be otherwise
+    MessageManager::callAsync ([strip] { repaintWaiting (strip); });
+}
+
+void RotaryFilmstrips::repaintWaiting (const std::weak_ptr<Strip>& strip)
+{
+    auto s = strip.lock();
+    if (s == nullptr)
+        return;
+
+    for (auto& component: s->waiting)
+        if (component != nullptr)
+            component->repaint();
+    s->waiting.clear();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "JuceHeader.h"
+#include "../utilities/multithreading/WorkStealingPool.h"
+
+/**
+ * Knob images pre-rendered at a range of angles, so a knob can be painted by copying the nearest frame instead of
+ * resampling its image at an arbitrary rotation.
+ *
+ * Strips are rendered on a background thread at the physical size they'll be drawn at, and shared between every knob
+ * that draws the same image at the same size. Until a strip is ready, draw the image the slow way with getTransform.
+ * Every knob that asked for a strip before it was ready is repainted once it is.
+ *
+ * Message thread only, apart from the rendering. Share it with a SharedResourcePointer.
+ */
+struct RotaryFilmstrips
+{
+    static constexpr int   numFrames     = 64;
+    static constexpr float travelDegrees = 270.0f;
+
+    struct Strip
+    {
+        bool isReady() const noexcept { return ready.load (std::memory_order_acquire); }
+
+        /** The frame nearest to a knob position, only call this once isReady() is true */
+        const juce::Image& getFrame (float normalisedValue) const noexcept;
+
+    private:
+        friend struct RotaryFilmstrips;
+        std::vector<juce::Image> frames;
+        std::atomic<bool>        ready { false };
+        // message thread only
+        std::vector<juce::Component::SafePointer<juce::Component>> waiting;
+    };
+
+    RotaryFilmstrips() = default;
+
+    /**
+     * Returns the strip for an image drawn into a component of this size, queueing it to be rendered if it's new.
+     * The component is repainted when the strip becomes ready, if it isn't already.
+     */
+    std::shared_ptr<const Strip> get (const juce::Image& image, int width, int height, float scale, juce::Component& component);
+
+    /** Where a knob image goes in a component of the given size when it's turned to the given angle */
+    static juce::AffineTransform getTransform (const juce::Image& image, float width, float height, float angle);
+
+    /** The angle a knob is turned to at a normalised value */
+    static float getAngle (float normalisedValue) { return juce::degreesToRadians (normalisedValue * travelDegrees); }
+
+private:
+    using Key = std::tuple<const void*, int, int, float>;
+
+    std::map<Key, std::weak_ptr<Strip>> strips;
+    nlt::WorkStealingPool               pool { 1 };
+
+    static void render (std::weak_ptr<Strip> strip, juce::Image image, int width, int height, float scale);
+    static void repaintWaiting (const std::weak_ptr<Strip>& strip);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RotaryFilmstrips)
+};
@@ -14,25 +14,7 @@ SequencerComponent::SequencerComponent(const String& name)
     :   seqName (name, name)
 {
     setLookAndFeel (&look);
-    toggleValues.resize (64, false);
-
-    for (auto i = 0; i < 64; ++i)
-    {
-        auto t = toggles.add (std::make_unique<ToggleButton>());
-        t->setClickingTogglesState (true);
-        t->setMouseCursor (MouseCursor::PointingHandCursor);
-        t->onClick = [this, t, i]()
-        {
-            if (!blockSequenceEditOutput)
-            {
-                toggleValues[i] = t->getToggleState();
-                sendSynchronousChangeMessage();
-            }
-        };
-        if (i % 4 == 0)
-            t->setColour (ToggleButton::textColourId, Colours::lightgrey);
-        addAndMakeVisible (t);
-    }
+    setMouseCursor (MouseCursor::PointingHandCursor);
 
     stepBox = std::make_unique<StepBox>();
     addAndMakeVisible (*stepBox);
@@ -40,6 +22,7 @@ SequencerComponent::SequencerComponent(const String& name)
     seqName.setColour (Label::textColourId, Colours::black);
     seqName.setJustificationType (Justification::right);
     seqName.setFont (15.0f);
+    seqName.setMouseCursor (MouseCursor::NormalCursor);
     addAndMakeVisible (seqName);
 }
 
@@ -50,8 +33,29 @@ SequencerComponent::~SequencerComponent()
 
 void SequencerComponent::paint (Graphics& g)
 {
-    //    g.setColour (Colours::black);
-    //    g.fillRect (getLocalBounds());
+    auto clip = g.getClipBounds();
+    for (auto i = 0; i < numSteps; ++i)
+        if (getStepBounds (i).intersects (clip))
+            paintStep (g, i);
+}
+
+void SequencerComponent::paintStep (Graphics& g, int step)
+{
+    // a square the height of the step, in the middle of it
+    auto bounds = getStepBounds (step).toFloat();
+    auto length = jmin (bounds.getWidth(), bounds.getHeight());
+    auto box    = bounds.withWidth (length).withCentre (bounds.getCentre());
+
+    g.setColour (step % 4 == 0 ? Colours::lightgrey : findColour (ToggleButton::textColourId));
+    g.fillRoundedRectangle (box, 4.0f);
+    g.setColour (findColour (ToggleButton::tickDisabledColourId));
+    g.drawRoundedRectangle (box, 4.0f, 2.0f);
+
+    if (SequenceWire::isSet (steps, step))
+    {
+        g.setColour (findColour (ToggleButton::tickColourId));
+        g.fillRoundedRectangle (box.reduced (2.0f), 4.0f);
+    }
 }
 
 void SequencerComponent::resized()
@@ -59,13 +63,50 @@ void SequencerComponent::resized()
     auto bounds       = getLocalBounds().toFloat();
     seqName.setBounds (bounds.removeFromLeft (35).toNearestInt().withWidth (46));
 
-    auto toggleWidth  = bounds.getWidth() / (float) jmax (numSteps, 1);
-    auto toggleHeight = bounds.getHeight();
-    for (auto i = 0; i < numSteps; ++i)
-    {
-        auto toggleBounds = Rectangle<float> ((float) i * toggleWidth + bounds.getX(), 0, toggleWidth, toggleHeight);
-        toggles[i]->setBounds (toggleBounds.toNearestInt().reduced (3, 1));
-    }
+    gridX     = bounds.getX();
+    stepWidth = bounds.getWidth() / (float) jmax (numSteps, 1);
+}
+
+Rectangle<int> SequencerComponent::getStepBounds (int step) const
+{
+    auto stepBounds = Rectangle<float> ((float) step * stepWidth + gridX, 0, stepWidth, (float) getHeight());
+    return stepBounds.toNearestInt().reduced (3, 1);
+}
+
+int SequencerComponent::getStepAt (Point<int> position) const
+{
+    if (stepWidth <= 0.0f)
+        return -1;
+
+    auto step = static_cast<int> (std::floor (((float) position.x - gridX) / stepWidth));
+    if (!isPositiveAndBelow (step, numSteps) || !getStepBounds (step).contains (position))
+        return -1;
+    return step;
+}
+
+void SequencerComponent::mouseDown (const MouseEvent& e)
+{
+    auto step = getStepAt (e.getPosition());
+    if (step < 0)
+        return;
+
+    dragState = !SequenceWire::isSet (steps, step);
+    editStep (step, dragState);
+}
+
+void SequencerComponent::mouseDrag (const MouseEvent& e)
+{
+    auto step = getStepAt (e.getPosition());
+    if (step >= 0 && SequenceWire::isSet (steps, step) != dragState)
+        editStep (step, dragState);
+}
+
+void SequencerComponent::editStep (int step, bool on)
+{
+    steps          = SequenceWire::withStep (steps, step, on);
+    lastEditedStep = step;
+    repaintStep (step);
+    sendSynchronousChangeMessage();
 }
 
 void SequencerComponent::setSequenceLength (int newNumSteps)
@@ -73,47 +114,43 @@ void SequencerComponent::setSequenceLength (int newNumSteps)
     if (numSteps != newNumSteps)
     {
         numSteps = newNumSteps;
-
-        for (auto i = 0; i < toggles.size(); ++i)
-            toggles[i]->setVisible (i < numSteps);
-
         resized();
+        repaint();
     }
 }
 
 void SequencerComponent::setSequenceWithEvent (const RNBO::MessageEvent& event)
 {
-    auto   melodyList = event.getListValue().get();
-    size_t length     = melodyList->length;
-    jassert (length <= toggleValues.size());
-
-    for (auto i = 0; i < length; ++i)
-        toggles[i]->setInterceptsMouseClicks (false, false);
-
+    if (event.getType() == RNBO::MessageEvent::List)
     {
-        ScopedValueSetter<bool> scopedEditBlocker { blockSequenceEditOutput, true };
-        for (auto i = 0; i < length; ++i)
-        {
-            toggleValues[i] = static_cast<bool> ((*melodyList)[i]);
-            toggles[i]->setToggleState (toggleValues[i], juce::sendNotificationSync);
-        }
-        setSequenceLength (numSteps);
+        SequenceWire::Mask mask;
+        if (auto list = event.getListValue(); list != nullptr && SequenceWire::fromMask (*list, mask))
+            setSequence (mask);
+    }
+    else
+    {
+        int  step;
+        bool on;
+        if (SequenceWire::decodeStep (event.getNumValue(), step, on))
+            setStep (step, on);
     }
-    for (auto i = 0; i < length; ++i)
-        toggles[i]->setInterceptsMouseClicks (true, true);
 }
 
-std::vector<bool> SequencerComponent::getCurrentSequence() const
+void SequencerComponent::setSequence (SequenceWire::Mask newSteps)
 {
-    auto first = toggleValues.begin();
-    auto last  = toggleValues.end();
-    return { first, last };
+    // only repaint the steps that changed, a regenerated pattern usually shares most of its steps
+    auto changed = steps ^ newSteps;
+    steps        = newSteps;
+
+    for (auto i = 0; changed != 0; ++i, changed >>= 1)
+        if ((changed & 1) != 0 && i < numSteps)
+            repaintStep (i);
 }
 
-void SequencersContainer::add (RNBO::MessageTag tag)
+void SequencerComponent::setStep (int step, bool on)
 {
-    auto s            = sequencers.add (std::make_unique<SequencerComponent>(""));
-    sequencerMap[tag] = s;
+    if (isPositiveAndBelow (step, SequenceWire::maxSteps))
+        setSequence (SequenceWire::withStep (steps, step, on));
 }
 
 SequencerStepIndicator::SequencerStepIndicator()
@@ -10,7 +10,12 @@
 #include "JuceHeader.h"
 #include "RNBO.h"
 #include "LookAndFeel/ChippoLookAndFeel.h"
+#include "messaging/SequenceWire.h"
 
+/**
+ * One track's steps, drawn and hit-tested as a single grid rather than a button per step. Clicking a step toggles it,
+ * and dragging across others sets them the same way. Changing the sequence only repaints the steps that changed.
+ */
 struct SequencerComponent : public Component, public ChangeBroadcaster
 {
     SequencerComponent (const String& name);
@@ -19,38 +24,41 @@ struct SequencerComponent : public Component, public ChangeBroadcaster
     void paint (Graphics& g) override;
     void resized() override;
 
+    void mouseDown (const MouseEvent& e) override;
+    void mouseDrag (const MouseEvent& e) override;
+
+    /** Takes a whole sequence as a mask, or a single step as a number. See SequenceWire */
     void setSequenceWithEvent (const RNBO::MessageEvent& event);
+    void setSequence (SequenceWire::Mask newSteps);
+    void setStep (int step, bool on);
     void setSequenceLength (int newNumSteps);
 
-    std::vector<bool> getCurrentSequence() const;
+    SequenceWire::Mask getCurrentSequence() const noexcept { return steps; }
+    /** The step the user last clicked, for sending just that step to the patch */
+    int getLastEditedStep() const noexcept { return lastEditedStep; }
 
 private:
     ChippoLook::SequencerToggleLook look;
-    OwnedArray<ToggleButton>        toggles;
-    std::vector<bool>               toggleValues;
+    SequenceWire::Mask              steps { 0 };
+    int                             lastEditedStep { -1 };
     int                             numSteps { 8 };
     std::unique_ptr<Component>      stepBox;
-    bool                            blockSequenceEditOutput { false };
     Label                           seqName;
+    // where the steps start and how wide each one is, set in resized
+    float                           gridX { 0.0f };
+    float                           stepWidth { 0.0f };
+    // what a drag sets the steps it crosses to, the state of the step it started on after toggling
+    bool                            dragState { false };
+
+    Rectangle<int> getStepBounds (int step) const;
+    int            getStepAt (Point<int> position) const;
+    void           paintStep (Graphics& g, int step);
+    void           repaintStep (int step) { repaint (getStepBounds (step)); }
+    void           editStep (int step, bool on);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SequencerComponent)
 };
 
-struct SequencersContainer
-{
-    SequencersContainer() = default;
-
-    void add (RNBO::MessageTag tag);
-
-    inline SequencerComponent* operator[] (RNBO::MessageTag tag) const noexcept { return sequencerMap.at (tag); }
-
-private:
-    OwnedArray<SequencerComponent>                  sequencers;
-    std::map<RNBO::MessageTag, SequencerComponent*> sequencerMap;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SequencersContainer)
-};
-
 struct SequencerStepIndicator : public Component
 {
     SequencerStepIndicator();
@@ -1,4 +1,5 @@
 #include "SliderMasked.h"
+#include "Assets.h"
 
 SliderMasked::SliderMasked()
 {
@@ -11,31 +12,94 @@ SliderMasked::SliderMasked()
 
 void SliderMasked::paint (Graphics& g)
 {
-    g.drawImageWithin (bgImg, 0, 0, getWidth(), getHeight() - 1, RectanglePlacement::stretchToFit);
-    auto value      = normalisedRange.convertTo0to1 (getValue());
-    auto height     = static_cast<float> (getHeight() - 1);
-    auto fillHeight = static_cast<float> (fillImg.getHeight());
-    auto fillClip =
-        fillImg.getClippedImage ({ 0,
-                                   jmin (static_cast<int> (round (fillHeight - (value * fillHeight))), fillImg.getHeight() + 10),
-                                   fillImg.getWidth(),
-                                   jmin (static_cast<int> (round (value * fillHeight)), fillImg.getHeight() + 10) });
-    g.drawImageWithin (fillClip,
-                       0,
-                       static_cast<int> (round (height - (value * height))),
-                       getWidth(),
-                       jmin (static_cast<int> (round (value * height)), getHeight() + 10),
-                       RectanglePlacement::stretchToFit);
+    if (getWidth() <= 0 || getHeight() <= 1)
+        return;
+
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (!approximatelyEqual (scale, cacheScale))
+        updateCache (scale);
+
+    // the caches are at physical size, so drawing them back into these bounds doesn't resample
+    auto bounds = Rectangle<float> (0.0f, 0.0f, static_cast<float> (getWidth()), static_cast<float> (getHeight() - 1));
+    g.drawImage (bgCache, bounds, RectanglePlacement::stretchToFit);
+
+    // the fill stretched over the whole glass and clipped to the value is the same as stretching its bottom part
+    auto value  = normalisedRange.convertTo0to1 (static_cast<float> (getValue()));
+    auto height = static_cast<float> (getHeight() - 1);
+    auto fillY  = static_cast<int> (round (height - (value * height)));
+
+    Graphics::ScopedSaveState state (g);
+    g.reduceClipRegion (0, fillY, getWidth(), getHeight() - fillY);
+    g.drawImage (fillCache, bounds, RectanglePlacement::stretchToFit);
+}
+
+void SliderMasked::resized()
+{
+    nlt::Slider::resized();
+    cacheScale = 0.0f;
+}
+
+void SliderMasked::updateCache (float scale)
+{
+    cacheScale = scale;
+
+    auto width  = jmax (1, roundToInt (static_cast<float> (getWidth()) * scale));
+    auto height = jmax (1, roundToInt (static_cast<float> (getHeight() - 1) * scale));
+
+    auto resample = [width, height] (Image source, const String& imageName)
+    {
+        if (imageName.isNotEmpty())
+            source = Assets::getImage (imageName, width, height);
+        if (!source.isValid())
+            return Image();
+
+        Image    resampled (Image::ARGB, width, height, true);
+        Graphics g (resampled);
+        g.setImageResamplingQuality (Graphics::highResamplingQuality);
+        g.drawImageWithin (source, 0, 0, width, height, RectanglePlacement::stretchToFit);
+        return resampled;
+    };
+
+    bgCache   = resample (bgImg, bgName);
+    fillCache = resample (fillImg, fillName);
+
+    if (fillCache.isValid() && fillClearFromTop > 0.0f)
+        fillCache.clear (fillCache.getBounds().removeFromTop (fillCache.getBounds().proportionOfHeight (fillClearFromTop)),
+                         Colours::transparentBlack);
+}
+
+void SliderMasked::setImageBg (const String& imageName)
+{
+    bgImg      = {};
+    bgName     = imageName;
+    cacheScale = 0.0f;
+    repaint();
+}
+
+void SliderMasked::setImageFill (const String& imageName, float proportionToClearFromTop)
+{
+    fillImg          = {};
+    fillName         = imageName;
+    fillClearFromTop = proportionToClearFromTop;
+    cacheScale       = 0.0f;
+    repaint();
 }
 
 void SliderMasked::setImageBg (Image bg)
 {
-    bgImg = bg;
+    bgImg      = bg;
+    bgName     = {};
+    cacheScale = 0.0f;
+    repaint();
 }
 
 void SliderMasked::setImageFill (Image fill)
 {
-    fillImg = fill;
+    fillImg          = fill;
+    fillName         = {};
+    fillClearFromTop = 0.0f;
+    cacheScale       = 0.0f;
+    repaint();
 }
 
 void SliderMasked::setParameter (RangedAudioParameter& parameter)
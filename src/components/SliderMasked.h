@@ -7,16 +7,33 @@ struct SliderMasked : public nlt::Slider
     SliderMasked();
 
     void paint (Graphics& g) override;
+    void resized() override;
 
     void setImageBg (Image bg);
     void setImageFill (Image fill);
 
+    /** Embedded images by their names, loaded at the size they're drawn at. See Assets */
+    void setImageBg (const String& imageName);
+    /** @param proportionToClearFromTop  how much of the top of the fill to leave out, so it sits lower in the glass */
+    void setImageFill (const String& imageName, float proportionToClearFromTop = 0.0f);
+
     void setParameter (RangedAudioParameter& parameter);
 
 private:
     Image                                      bgImg;
     Image                                      fillImg;
+    String                                     bgName;
+    String                                     fillName;
+    float                                      fillClearFromTop { 0.0f };
     std::unique_ptr<SliderParameterAttachment> attachment;
 
+    // bgImg and fillImg already resampled to the pixels they're drawn on, so painting is a copy and a clip.
+    // Rebuilt when the size, zoom or display scale changes
+    Image bgCache;
+    Image fillCache;
+    float cacheScale { 0.0f };
+
+    void updateCache (float scale);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SliderMasked)
 };
@@ -1,4 +1,5 @@
 #include "SliderRotary.h"
+#include "Assets.h"
 
 SliderRotary::SliderRotary()
 {
@@ -18,38 +19,69 @@ void SliderRotary::paint (Graphics& g)
         return;
     }
 
-    auto& img = images[getImageIndex()];
+    auto index = getImageIndex();
+    auto value = normalisedRange.convertTo0to1 (static_cast<float> (getValue()));
 
-    auto travelRotation = juce::degreesToRadians (normalisedRange.convertTo0to1 (static_cast<float> (getValue())) * 270.0f);
-
-    auto angle = travelRotation;
-
-    auto imgW = static_cast<float> (img.getWidth());
-    auto imgH = static_cast<float> (img.getHeight());
-
-    auto compW = static_cast<float> (getWidth());
-    auto compH = static_cast<float> (getHeight());
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (strip == nullptr || index != stripImageIndex || !approximatelyEqual (scale, stripScale))
+    {
+        stripSource     = getImageToDraw (index, scale);
+        strip           = stripSource.isValid() ? filmstrips->get (stripSource, getWidth(), getHeight(), scale, *this) : nullptr;
+        stripImageIndex = index;
+        stripScale      = scale;
+    }
 
-    auto scaleFactor = juce::jmin (compW / imgW, compH / imgH);
+    if (strip == nullptr)
+        return;
 
-    auto scaledW = imgW * scaleFactor;
-    auto scaledH = imgH * scaleFactor;
+    if (strip->isReady())
+    {
+        g.drawImage (strip->getFrame (value), getLocalBounds().toFloat());
+        return;
+    }
 
-    auto drawX = (compW - scaledW) * 0.5f;
-    auto drawY = (compH - scaledH) * 0.5f;
+    auto t = RotaryFilmstrips::getTransform (stripSource,
+                                             static_cast<float> (getWidth()),
+                                             static_cast<float> (getHeight()),
+                                             RotaryFilmstrips::getAngle (value));
+    g.drawImageTransformed (stripSource, t, false);
+}
 
-    auto pivotX = drawX + scaledW * 0.5f;
-    auto pivotY = drawY + scaledH * 0.5f;
+void SliderRotary::resized()
+{
+    nlt::Slider::resized();
+    strip = nullptr;
+}
 
-    juce::AffineTransform t =
-        juce::AffineTransform::scale (scaleFactor).translated (drawX, drawY).rotated (angle, pivotX, pivotY);
+Image SliderRotary::getImageToDraw (size_t index, float scale) const
+{
+    auto& name = imageNames[index];
+    if (name.isEmpty())
+        return images[index];
+
+    // the image is fitted into the bounds, so only the side that touches them needs to be covered
+    auto full = Assets::getFullBounds (name).toFloat();
+    if (full.isEmpty())
+        return {};
+
+    auto fit = jmin (static_cast<float> (getWidth()) * scale / full.getWidth(),
+                     static_cast<float> (getHeight()) * scale / full.getHeight());
+    return Assets::getImage (name,
+                             roundToInt (std::ceil (full.getWidth() * fit)),
+                             roundToInt (std::ceil (full.getHeight() * fit)));
+}
 
-    g.drawImageTransformed (img, t, false);
+void SliderRotary::addImage (const String& imageName)
+{
+    addImage (Image());
+    imageNames.back() = imageName;
 }
 
 void SliderRotary::addImage (const Image& newImg)
 {
     images.push_back (newImg);
+    imageNames.emplace_back();
+    strip = nullptr;
     auto size = (int) images.size();
     if (size > 1)
         currentImageIndex = (size_t) Random().nextInt (size);
@@ -64,6 +96,8 @@ void SliderRotary::setParameter (RangedAudioParameter& parameter)
 void SliderRotary::clearImages()
 {
     images.clear();
+    imageNames.clear();
+    strip = nullptr;
     repaint();
 }
 
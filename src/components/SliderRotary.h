@@ -1,5 +1,6 @@
 #pragma once
 #include "../parameter-handling/Slider.h"
+#include "RotaryFilmstrips.h"
 #include "RNBO.h"
 
 struct SliderRotary : public nlt::Slider
@@ -7,8 +8,11 @@ struct SliderRotary : public nlt::Slider
     SliderRotary();
 
     void paint (Graphics& g) override;
+    void resized() override;
 
     void addImage (const Image& newImg);
+    /** Adds an embedded image by its name, loaded at the size it's drawn at. See Assets */
+    void addImage (const String& imageName);
 
     void clearImages();
 
@@ -17,10 +21,20 @@ struct SliderRotary : public nlt::Slider
 private:
     float                                      prevNormalisedValue { 0.0f };
     std::vector<Image>                         images;
+    // the name of each embedded image added by name, empty for the others
+    std::vector<String>                        imageNames;
     std::unique_ptr<SliderParameterAttachment> attachment;
     size_t                                     currentImageIndex { 0 };
 
+    // the current image pre-rendered at every angle for the size and scale it was last painted at
+    SharedResourcePointer<RotaryFilmstrips>        filmstrips;
+    std::shared_ptr<const RotaryFilmstrips::Strip> strip;
+    Image                                          stripSource;
+    size_t                                         stripImageIndex { 0 };
+    float                                          stripScale { 0.0f };
+
     size_t getImageIndex();
+    Image  getImageToDraw (size_t index, float scale) const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SliderRotary)
 };
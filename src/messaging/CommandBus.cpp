@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    CommandBus.cpp
+
+  ==============================================================================
+*/
+
+#include "CommandBus.h"
+
+using namespace juce;
+
+CommandBus::CommandBus (RNBO::CoreObject& rnboObject)
+    : rnbo (rnboObject)
+    , bangTag (RNBO::TAG (""))
+    , parameterValues (static_cast<size_t> (jmax (0, rnboObject.getNumParameters())))
+    , parameterQueued (static_cast<size_t> (jmax (0, rnboObject.getNumParameters())))
+{
+    for (size_t i = 0; i < capacity; ++i)
+        slots[i].sequence.store (i, std::memory_order_relaxed);
+}
+
+bool CommandBus::setParameter (RNBO::ParameterIndex index, RNBO::ParameterValue value)
+{
+    if (!isPositiveAndBelow (index, static_cast<int> (parameterValues.size())))
+    {
+        jassertfalse; // not one of the RNBO object's parameters
+        return false;
+    }
+
+    auto i = static_cast<size_t> (index);
+    parameterValues[i].store (value, std::memory_order_relaxed);
+
+    // already waiting in the ring, which will pick up this value instead
+    if (parameterQueued[i].exchange (true, std::memory_order_acq_rel))
+        return true;
+
+    if (push ({ Command::parameter, 0, index, 0, nullptr }))
+        return true;
+
+    parameterQueued[i].store (false, std::memory_order_release);
+    return false;
+}
+
+bool CommandBus::sendMessage (RNBO::MessageTag tag, RNBO::number value)
+{
+    return push ({ Command::number, tag, 0, value, nullptr });
+}
+
+bool CommandBus::sendList (RNBO::MessageTag tag, RNBO::UniqueListPtr list)
+{
+    jassert (list != nullptr);
+    return push ({ Command::list, tag, 0, 0, std::move (list) });
+}
+
+bool CommandBus::sendBang (RNBO::MessageTag tag)
+{
+    return push ({ Command::bang, tag, 0, 0, nullptr });
+}
+
+bool CommandBus::push (Command&& command) noexcept
+{
+    auto position = writePosition.load (std::memory_order_relaxed);
+    for (;;)
+    {
+        auto& slot     = slots[position % capacity];
+        auto  sequence = slot.sequence.load (std::memory_order_acquire);
+        auto  diff     = static_cast<std::ptrdiff_t> (sequence) - static_cast<std::ptrdiff_t> (position);
+
+        if (diff == 0)
+        {
+            if (writePosition.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+            {
+                slot.command = std::move (command);
+                slot.sequence.store (position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            // still holds a command from a lap ago
+            return false;
+        }
+        else
+        {
+            position = writePosition.load (std::memory_order_relaxed);
+        }
+    }
+}
+
+void CommandBus::drain() noexcept
+{
+    // only what was queued before this block, a parameter set again while draining waits for the next one
+    const auto end = writePosition.load (std::memory_order_relaxed);
+    while (readPosition != end)
+    {
+        auto& slot = slots[readPosition % capacity];
+        if (slot.sequence.load (std::memory_order_acquire) != readPosition + 1)
+            return;
+
+        auto command = std::move (slot.command);
+        slot.sequence.store (readPosition + capacity, std::memory_order_release);
+        ++readPosition;
+        send (command);
+    }
+}
+
+void CommandBus::send (Command& command) noexcept
+{
+    switch (command.type)
+    {
+        case Command::parameter:
+        {
+            auto i = static_cast<size_t> (command.index);
+            // cleared first, so a set that comes in after the value is read queues it again
+            parameterQueued[i].exchange (false, std::memory_order_acq_rel);
+            rnbo.setParameterValue (command.index, parameterValues[i].load (std::memory_order_relaxed));
+            break;
+        }
+        case Command::number:
+            rnbo.sendMessage (command.tag, command.value);
+            break;
+        case Command::list:
+            rnbo.sendMessage (command.tag, std::move (command.listValue));
+            break;
+        case Command::bang:
+            rnbo.sendMessage (command.tag, bangTag);
+            break;
+    }
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    CommandBus.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "JuceHeader.h"
+#include "RNBO.h"
+
+/**
+ * The one way commands get from the editor and background threads to the RNBO object.
+ *
+ * Any thread can queue parameter sets, numbers, lists and bangs. They go into a fixed ring of slots
+ * allocated up front, which senders claim with a compare and swap, so neither they nor the audio thread
+ * ever wait on a lock. The audio thread drains what was queued once at the top of processBlock.
+ *
+ * Each parameter has its own slot for the latest value set, and is only in the ring once until it's
+ * drained, so however often it's set in a block RNBO gets one value. Lists have to be heap allocated for
+ * RNBO anyway, so the sender builds them and the audio thread only moves them on.
+ *
+ * If the ring is full, which only happens when the audio isn't running, the command is dropped and the
+ * send returns false. Nothing but the audio thread ever hands commands to RNBO.
+ */
+struct CommandBus
+{
+    explicit CommandBus (RNBO::CoreObject& rnboObject);
+
+    // any thread, each returns false if the command was dropped ===========================
+
+    bool setParameter (RNBO::ParameterIndex index, RNBO::ParameterValue value);
+    bool sendMessage (RNBO::MessageTag tag, RNBO::number value);
+    bool sendList (RNBO::MessageTag tag, RNBO::UniqueListPtr list);
+    bool sendBang (RNBO::MessageTag tag);
+
+    // audio thread ===================================================================
+
+    /** Call at the top of processBlock, hands everything queued before it to RNBO */
+    void drain() noexcept;
+
+private:
+    static constexpr size_t capacity = 256;
+
+    struct Command
+    {
+        enum Type
+        {
+            parameter,
+            number,
+            list,
+            bang
+        };
+
+        Type                 type { bang };
+        RNBO::MessageTag     tag { 0 };
+        RNBO::ParameterIndex index { 0 };
+        RNBO::number         value { 0 };
+        RNBO::UniqueListPtr  listValue;
+    };
+
+    struct Slot
+    {
+        /** equal to the write position the slot is free for, one past it once it's been written */
+        std::atomic<size_t> sequence { 0 };
+        Command             command;
+    };
+
+    RNBO::CoreObject&      rnbo;
+    const RNBO::MessageTag bangTag;
+
+    std::array<Slot, capacity> slots;
+    std::atomic<size_t>        writePosition { 0 };
+    size_t                     readPosition { 0 };
+
+    // the latest value set for each parameter, and whether it's in the ring waiting to be drained
+    std::vector<std::atomic<RNBO::ParameterValue>> parameterValues;
+    std::vector<std::atomic<bool>>                 parameterQueued;
+
+    bool push (Command&& command) noexcept;
+    void send (Command& command) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CommandBus)
+};
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    MessageRouter.cpp
+
+  ==============================================================================
+*/
+
+#include "MessageRouter.h"
+#include <numeric>
+
+using namespace juce;
+
+void MessageRouter::add (RNBO::MessageTag tag, Handler handler)
+{
+    jassert (handler != nullptr);
+    routes.emplace_back (tag, std::move (handler));
+    rebuild();
+}
+
+void MessageRouter::rebuild()
+{
+    // group handlers by tag, keeping the order they were added in
+    std::vector<size_t> order (routes.size());
+    std::iota (order.begin(), order.end(), size_t { 0 });
+    std::stable_sort (order.begin(), order.end(), [this] (size_t a, size_t b) { return routes[a].first < routes[b].first; });
+
+    handlers.clear();
+    handlers.reserve (routes.size());
+    for (auto i: order)
+        handlers.push_back (routes[i].second);
+
+    // at most half full, so probe chains stay short
+    uint32 bits = 1;
+    while ((1u << bits) < routes.size() * 2)
+        ++bits;
+    shift = 32 - bits;
+    slots.assign (size_t { 1 } << bits, {});
+
+    for (size_t i = 0; i < order.size();)
+    {
+        auto tag   = routes[order[i]].first;
+        auto first = i;
+        while (i < order.size() && routes[order[i]].first == tag)
+            ++i;
+
+        auto index = slotFor (tag);
+        while (slots[index].count != 0)
+            index = (index + 1) & static_cast<uint32> (slots.size() - 1);
+        slots[index] = { tag, static_cast<uint32> (first), static_cast<uint32> (i - first) };
+    }
+}
+
+bool MessageRouter::dispatch (const RNBO::MessageEvent& event) const
+{
+    if (slots.empty())
+        return false;
+
+    auto tag  = event.getTag();
+    auto mask = static_cast<uint32> (slots.size() - 1);
+    for (auto index = slotFor (tag); slots[index].count != 0; index = (index + 1) & mask)
+    {
+        auto& slot = slots[index];
+        if (slot.tag == tag)
+        {
+            for (auto h = slot.first; h < slot.first + slot.count; ++h)
+                handlers[h](event);
+            return true;
+        }
+    }
+    return false;
+}
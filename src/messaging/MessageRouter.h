@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    MessageRouter.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "JuceHeader.h"
+#include "RNBO.h"
+
+/**
+ * Hands RNBO message events to the handlers registered for their tag.
+ *
+ * Routes are added while setting up. Each add() rebuilds a small open addressed table keyed on the tag,
+ * with each tag's handlers stored next to each other. Dispatching is then one hash and usually one
+ * compare, whatever the number of outports, and never allocates.
+ *
+ * Not thread safe: add everything before events start arriving, and dispatch from one thread.
+ */
+struct MessageRouter
+{
+    using Handler = std::function<void (const RNBO::MessageEvent&)>;
+
+    MessageRouter() = default;
+
+    void add (RNBO::MessageTag tag, Handler handler);
+    void add (const char* tagName, Handler handler) { add (RNBO::TAG (tagName), std::move (handler)); }
+
+    /** Calls every handler for the event's tag. Returns false if there weren't any */
+    bool dispatch (const RNBO::MessageEvent& event) const;
+
+private:
+    struct Slot
+    {
+        RNBO::MessageTag tag { 0 };
+        juce::uint32     first { 0 };
+        /** 0 marks an empty slot */
+        juce::uint32     count { 0 };
+    };
+
+    std::vector<std::pair<RNBO::MessageTag, Handler>> routes;
+    std::vector<Handler>                              handlers;
+    std::vector<Slot>                                 slots;
+    juce::uint32                                      shift { 32 };
+
+    void rebuild();
+
+    juce::uint32 slotFor (RNBO::MessageTag tag) const noexcept
+    {
+        // Fibonacci hashing, the top bits of the product are the best mixed
+        return static_cast<juce::uint32> ((static_cast<juce::uint32> (tag) * 0x9e3779b1u) >> shift);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MessageRouter)
+};
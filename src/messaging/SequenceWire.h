@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    SequenceWire.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "JuceHeader.h"
+#include "RNBO.h"
+
+/**
+ * The forms sequences take between the editor and the patch.
+ *
+ * A whole sequence is a mask of two numbers, steps 0-31 as the bits of the first and 32-63 as the bits of
+ * the second, which the patch sends out of <track>SequenceOut whenever it generates, clears or recalls one.
+ * A single step is one number on <track>StepIn and <track>StepOut, step * 2 + (on ? 1 : 0), so clicking a
+ * step goes through sendMessage without building a list at all. See the mask and step-set codeboxes in
+ * each sequencer-track subpatcher of Chippo.maxpat.
+ *
+ * In the editor a sequence is a 64 bit mask, bit n being step n.
+ */
+namespace SequenceWire
+{
+
+using Mask = juce::uint64;
+
+static constexpr int maxSteps = 64;
+
+inline constexpr Mask bit (int step) noexcept { return Mask { 1 } << step; }
+inline constexpr bool isSet (Mask mask, int step) noexcept { return (mask & bit (step)) != 0; }
+inline constexpr Mask withStep (Mask mask, int step, bool on) noexcept
+{
+    return on ? (mask | bit (step)) : (mask & ~bit (step));
+}
+
+inline RNBO::number encodeStep (int step, bool on) noexcept
+{
+    return static_cast<RNBO::number> (step * 2 + (on ? 1 : 0));
+}
+
+/** Returns false if the value isn't a whole number naming a step in range */
+inline bool decodeStep (RNBO::number value, int& step, bool& on) noexcept
+{
+    // checked before converting, casting a NaN or out of range double to int is undefined
+    if (!(value >= 0 && value < maxSteps * 2) || value != std::floor (value))
+        return false;
+
+    auto n = static_cast<int> (value);
+    step   = n >> 1;
+    on     = (n & 1) != 0;
+    return true;
+}
+
+/** Reads the two halves of a mask. Returns false, leaving mask alone, unless both are whole numbers below 2^32 */
+inline bool fromMask (const RNBO::list& list, Mask& mask) noexcept
+{
+    if (list.length != 2)
+        return false;
+
+    Mask result = 0;
+    for (size_t i = 0; i < 2; ++i)
+    {
+        // checked before converting, like decodeStep
+        if (!(list[i] >= 0 && list[i] < 4294967296.0) || list[i] != std::floor (list[i]))
+            return false;
+
+        result |= static_cast<Mask> (list[i]) << (32 * i);
+    }
+
+    mask = result;
+    return true;
+}
+
+} // namespace SequenceWire
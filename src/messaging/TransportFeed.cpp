@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    TransportFeed.cpp
+
+  ==============================================================================
+*/
+
+#include "TransportFeed.h"
+#include "components/ParamIdentifiers.h"
+
+using namespace juce;
+
+TransportFeed::TransportFeed (RNBO::CoreObject& rnboObject)
+    : rnbo (rnboObject)
+    , triggerInterface (rnboObject.createParameterInterface (RNBO::ParameterEventInterface::Trigger, this))
+    , stepTag (RNBO::TAG (Outports::stepPosition))
+{
+}
+
+void TransportFeed::prepare (double newSampleRate) noexcept
+{
+    sampleRate     = newSampleRate;
+    lastStepRnboMs = -1.0;
+    msPerStep      = 0.0;
+    pendingStep    = -1;
+}
+
+void TransportFeed::blockStarted (int numSamples) noexcept
+{
+    blockWallMs   = Time::getMillisecondCounterHiRes();
+    blockRnboMs   = rnbo.getCurrentTime();
+    blockLengthMs = numSamples * 1000.0 / sampleRate;
+}
+
+void TransportFeed::handleMessageEvent (const RNBO::MessageEvent& event)
+{
+    if (event.getTag() != stepTag)
+        return;
+
+    auto time = event.getTime();
+    if (lastStepRnboMs >= 0.0 && time > lastStepRnboMs)
+        msPerStep = time - lastStepRnboMs;
+
+    lastStepRnboMs = time;
+    pendingRnboMs  = time;
+    pendingStep    = static_cast<int> (event.getNumValue());
+}
+
+void TransportFeed::blockEnded() noexcept
+{
+    if (pendingStep < 0)
+        return;
+
+    if (listening.load (std::memory_order_relaxed))
+    {
+        // the block is heard roughly one block after it's processed
+        Frame frame { pendingStep, blockWallMs + blockLengthMs + (pendingRnboMs - blockRnboMs), msPerStep };
+
+        // if the editor has fallen that far behind, dropping a frame doesn't matter, each one holds everything
+        const auto scope = fifo.write (1);
+        if (scope.blockSize1 > 0)
+            frames[static_cast<size_t> (scope.startIndex1)] = frame;
+    }
+    pendingStep = -1;
+}
+
+double TransportFeed::getPosition (double nowMs) noexcept
+{
+    const auto scope = fifo.read (fifo.getNumReady());
+    for (auto i = 0; i < scope.blockSize1; ++i)
+        receive (frames[static_cast<size_t> (scope.startIndex1 + i)]);
+    for (auto i = 0; i < scope.blockSize2; ++i)
+        receive (frames[static_cast<size_t> (scope.startIndex2 + i)]);
+
+    // a step is usually published a little before it's heard, keep showing the one playing until then
+    auto& frame = nowMs < latest.startMs && previous.step >= 0 ? previous : latest;
+    if (frame.step < 0 || frame.msPerStep <= 0.0)
+        return frame.step;
+
+    // never run into the next step, if the transport has stopped there won't be one
+    return frame.step + jlimit (0.0, 0.999, (nowMs - frame.startMs) / frame.msPerStep);
+}
+
+void TransportFeed::receive (const Frame& frame) noexcept
+{
+    previous = latest;
+    latest   = frame;
+}
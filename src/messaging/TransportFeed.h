@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    TransportFeed.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "JuceHeader.h"
+#include "RNBO.h"
+
+/**
+ * Gets the playhead from the audio thread to the editor without going through the message queue.
+ *
+ * The patch's stepPosition outport is caught on the audio thread, through a Trigger parameter interface.
+ * At the end of each block where the step changed, the audio thread pushes a frame holding the step,
+ * when it will be heard (on the Time::getMillisecondCounterHiRes() clock) and how long a step lasts, into
+ * a single producer single consumer FIFO. The editor reads it once per display frame and works out
+ * where the playhead is from the latest frames, so it moves on the frame the step is heard rather than
+ * whenever an event happens to get through the message queue.
+ */
+struct TransportFeed : private RNBO::EventHandler
+{
+    struct Frame
+    {
+        int    step { -1 };
+        /** when the step starts being heard */
+        double startMs { 0.0 };
+        /** 0 until two steps have been seen */
+        double msPerStep { 0.0 };
+    };
+
+    explicit TransportFeed (RNBO::CoreObject& rnboObject);
+    ~TransportFeed() override = default;
+
+    // audio thread ===================================================================
+
+    void prepare (double sampleRate) noexcept;
+
+    /** Call at the top of processBlock */
+    void blockStarted (int numSamples) noexcept;
+
+    /** Call once the block has been processed, publishes the step if it changed */
+    void blockEnded() noexcept;
+
+    // message thread =================================================================
+
+    /** Nothing is published while nobody is reading, so the FIFO doesn't fill up with stale frames */
+    void setListening (bool shouldListen) noexcept { listening.store (shouldListen, std::memory_order_relaxed); }
+
+    /**
+     * Returns the playhead at the given time in steps. The integer part is the step being heard and the rest is
+     * extrapolated from the step length. Returns a negative value before any step has been reported.
+     */
+    double getPosition (double nowMs) noexcept;
+
+private:
+    static constexpr int fifoSize = 64;
+
+    RNBO::CoreObject&                      rnbo;
+    RNBO::ParameterEventInterfaceUniquePtr triggerInterface;
+    const RNBO::MessageTag                 stepTag;
+
+    juce::AbstractFifo          fifo { fifoSize };
+    std::array<Frame, fifoSize> frames;
+    std::atomic<bool>           listening { false };
+
+    // audio thread only
+    double sampleRate { 44100.0 };
+    double blockWallMs { 0.0 };
+    double blockRnboMs { 0.0 };
+    double blockLengthMs { 0.0 };
+    double lastStepRnboMs { -1.0 };
+    double msPerStep { 0.0 };
+    double pendingRnboMs { 0.0 };
+    int    pendingStep { -1 };
+
+    // message thread only
+    Frame latest, previous;
+
+    void eventsAvailable() override {}
+    void handleMessageEvent (const RNBO::MessageEvent& event) override;
+    void receive (const Frame& frame) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TransportFeed)
+};
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "BatchRenderer.h"
+#include "state/PresetBank.h"
+
+using namespace juce;
+
+BatchRenderer::BatchRenderer (const OfflineRenderer::Settings& settingsToUse, int numWorkers)
+    : renderer (settingsToUse)
+    , pool (numWorkers)
+{
+}
+
+int BatchRenderer::render (const File& presetFolder, const File& outputFolder, const String& fileExtension)
+{
+    // each preset's path under presetFolder, which is also where its render goes under outputFolder
+    StringArray relativePaths;
+    // kept open for the whole batch, rather than mapped again for every preset
+    std::shared_ptr<const PresetBank> bank;
+    if (presetFolder.hasFileExtension (PresetBank::fileExtension))
+    {
+        // bank presets are addressed like files in a folder, OfflineRenderer reads them straight from the bank
+        if ((bank = PresetBank::open (presetFolder)) != nullptr)
+            for (auto i = 0; i < bank->getNumPresets(); ++i)
+                relativePaths.add (bank->getName (i) + "." + fileExtension);
+    }
+    else
+    {
+        for (auto& preset: presetFolder.findChildFiles (File::TypesOfFileToFind::findFiles, true, "*." + fileExtension))
+            relativePaths.add (preset.getRelativePathFrom (presetFolder));
+    }
+
+    outputFolder.createDirectory();
+    FileOutputStream manifest (outputFolder.getChildFile ("manifest.jsonl"));
+    manifest.setPosition (0);
+    manifest.truncate();
+
+    std::atomic<int> numFailed { 0 };
+
+    for (auto& relativePath: relativePaths)
+    {
+        auto preset = presetFolder.getChildFile (relativePath);
+        auto output = outputFolder.getChildFile (relativePath).withFileExtension ("wav");
+
+        // bank names come from the file, so don't let one like ../../x render outside the output folder
+        if (!output.isAChildOf (outputFolder))
+        {
+            ++numFailed;
+
+            auto* entry = new DynamicObject();
+            entry->setProperty ("preset", preset.getFullPathName());
+            entry->setProperty ("ok", false);
+            entry->setProperty ("error", "its output would be outside " + outputFolder.getFullPathName());
+
+            const ScopedLock lock (manifestLock);
+            manifest << JSON::toString (var (entry), true) << "\n";
+            continue;
+        }
+
+        pool.addJob (
+            [this, preset, output, &manifest, &numFailed] (int workerIndex)
+            {
+                auto start  = Time::getMillisecondCounterHiRes();
+                auto result = renderer.render (preset, output);
+                auto took   = Time::getMillisecondCounterHiRes() - start;
+
+                if (result.failed())
+                    ++numFailed;
+
+                auto* entry = new DynamicObject();
+                entry->setProperty ("preset", preset.getFullPathName());
+                entry->setProperty ("output", output.getFullPathName());
+                entry->setProperty ("worker", workerIndex);
+                entry->setProperty ("renderMs", took);
+                entry->setProperty ("audioMs",
+                                    1000.0 * static_cast<double> (renderer.getNumSamplesToRender())
+                                        / renderer.getSettings().sampleRate);
+                entry->setProperty ("ok", result.wasOk());
+                if (result.failed())
+                    entry->setProperty ("error", result.getErrorMessage());
+
+                const ScopedLock lock (manifestLock);
+                manifest << JSON::toString (var (entry), true) << "\n";
+                manifest.flush();
+            });
+    }
+
+    pool.waitForAll();
+    return numFailed.load();
+}
@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "OfflineRenderer.h"
+#include "utilities/multithreading/WorkStealingPool.h"
+
+/**
+ * Renders every preset under a folder (the same tree PresetBar shows), or in a preset bank, concurrently
+ * on a pool of workers. Every job gets a processor of its own, so what a preset renders to doesn't depend
+ * on which worker ran it or what that worker rendered before. Each finished job is written straight away,
+ * along with a line in manifest.jsonl in the output folder.
+ */
+struct BatchRenderer
+{
+    BatchRenderer (const OfflineRenderer::Settings& settingsToUse, int numWorkers = juce::SystemStats::getNumCpus());
+
+    /**
+     * Renders every preset with fileExtension found anywhere under presetFolder into outputFolder,
+     * keeping the sub folder layout. presetFolder can also be a PresetBank file.
+     * Returns the number of presets that failed.
+     */
+    int render (const juce::File& presetFolder, const juce::File& outputFolder, const juce::String& fileExtension = "hop");
+
+private:
+    const OfflineRenderer renderer;
+    nlt::WorkStealingPool pool;
+    juce::CriticalSection manifestLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BatchRenderer)
+};
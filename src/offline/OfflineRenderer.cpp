@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+#include "components/ParamIdentifiers.h"
+#include "components/ParameterTable.h"
+#include "state/PresetBank.h"
+
+using namespace juce;
+
+Optional<AudioPlayHead::PositionInfo> OfflineRenderer::FixedTempoPlayHead::getPosition() const
+{
+    auto seconds   = static_cast<double> (samplePosition) / sampleRate;
+    auto ppq       = seconds * bpm / 60.0;
+    auto barLength = static_cast<double> (beatsPerBar);
+
+    PositionInfo info;
+    info.setIsPlaying (true);
+    info.setBpm (bpm);
+    info.setTimeSignature (TimeSignature { beatsPerBar, 4 });
+    info.setTimeInSamples (samplePosition);
+    info.setTimeInSeconds (seconds);
+    info.setPpqPosition (ppq);
+    info.setPpqPositionOfLastBarStart (std::floor (ppq / barLength) * barLength);
+    info.setBarCount (static_cast<int64> (ppq / barLength));
+    return info;
+}
+
+OfflineRenderer::OfflineRenderer (const Settings& settingsToUse)
+    : settings (settingsToUse)
+{
+    jassert (settings.sampleRate > 0.0 && settings.blockSize > 0 && settings.bpm > 0.0);
+
+    // the patch has no seed inport, so this only pins down host side randomness.
+    // what gets played is fixed by the sequences stored in the preset
+    Random::getSystemRandom().setSeed (settings.seed);
+}
+
+int64 OfflineRenderer::getNumSamplesToRender() const
+{
+    auto numBeats = static_cast<double> (settings.numBars * settings.beatsPerBar);
+    return static_cast<int64> (std::ceil (numBeats * 60.0 / settings.bpm * settings.sampleRate));
+}
+
+Result OfflineRenderer::render (const File& presetFile, const File& outputFile) const
+{
+    MemoryBlock presetData;
+    if (!PresetBank::loadPreset (presetFile, presetData))
+        return Result::fail ("couldn't read " + presetFile.getFullPathName());
+
+    return render (presetData, outputFile);
+}
+
+Result OfflineRenderer::render (const MemoryBlock& presetData, const File& outputFile) const
+{
+    std::unique_ptr<CustomAudioProcessor> processor (CustomAudioProcessor::CreateDefault());
+    auto                                  numChannels = processor->getTotalNumOutputChannels();
+
+    // open the file before preparing, so there's nothing to undo if it can't be written
+    outputFile.deleteFile();
+    outputFile.getParentDirectory().createDirectory();
+    auto stream = std::make_unique<FileOutputStream> (outputFile);
+    if (!stream->openedOk())
+        return Result::fail ("couldn't write " + outputFile.getFullPathName());
+
+    WavAudioFormat                     wav;
+    std::unique_ptr<AudioFormatWriter> writer (
+        wav.createWriterFor (stream.get(), settings.sampleRate, (unsigned int) numChannels, settings.bitDepth, {}, 0));
+    if (writer == nullptr)
+        return Result::fail ("couldn't create a wav writer for " + outputFile.getFullPathName());
+    stream.release(); // the writer owns the stream now
+
+    FixedTempoPlayHead playHead;
+    playHead.bpm         = settings.bpm;
+    playHead.sampleRate  = settings.sampleRate;
+    playHead.beatsPerBar = settings.beatsPerBar;
+
+    processor->setNonRealtime (true);
+    processor->setPlayHead (&playHead);
+    processor->setPlayConfigDetails (processor->getTotalNumInputChannels(),
+                                     numChannels,
+                                     settings.sampleRate,
+                                     settings.blockSize);
+    processor->prepareToPlay (settings.sampleRate, settings.blockSize);
+
+    processor->setStateInformation (presetData.getData(), static_cast<int> (presetData.getSize()));
+    setRunning (*processor, true);
+
+    AudioBuffer<float> buffer (jmax (numChannels, processor->getTotalNumInputChannels()), settings.blockSize);
+    MidiBuffer         midi;
+
+    auto numSamples = getNumSamplesToRender();
+    while (playHead.samplePosition < numSamples)
+    {
+        auto blockLength = static_cast<int> (jmin ((int64) settings.blockSize, numSamples - playHead.samplePosition));
+        buffer.setSize (buffer.getNumChannels(), blockLength, false, false, true);
+        buffer.clear();
+        midi.clear();
+
+        processor->processBlock (buffer, midi);
+        writer->writeFromAudioSampleBuffer (buffer, 0, blockLength);
+
+        playHead.samplePosition += blockLength;
+    }
+
+    setRunning (*processor, false);
+    processor->releaseResources();
+    processor->setPlayHead (nullptr);
+    return Result::ok();
+}
+
+void OfflineRenderer::setRunning (CustomAudioProcessor& processor, bool shouldRun)
+{
+    for (auto* parameter: processor.getParameters())
+    {
+        if (auto* param = dynamic_cast<RangedAudioParameter*> (parameter))
+        {
+            if (ParameterTable::getIdentifier (*param) == Toggles::run)
+            {
+                param->setValueNotifyingHost (shouldRun ? 1.0f : 0.0f);
+                return;
+            }
+        }
+    }
+    jassertfalse; // the patch should always have a run parameter
+}
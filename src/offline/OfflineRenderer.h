@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "JuceHeader.h"
+#include "CustomAudioProcessor.h"
+
+/**
+ * Renders a Chippo state to disk without an editor or an audio device.
+ * Every render builds its own processor, so nothing from one render (reverb tails,
+ * voices, where the sequencer had got to) carries into the next, and one renderer
+ * can be used from several threads at once.
+ */
+struct OfflineRenderer
+{
+    struct Settings
+    {
+        double sampleRate { 48000.0 };
+        int    blockSize { 512 };
+        int    numBars { 4 };
+        int    beatsPerBar { 4 };
+        double bpm { 120.0 };
+        int    bitDepth { 24 };
+        int64  seed { 0 };
+    };
+
+    explicit OfflineRenderer (const Settings& settingsToUse);
+
+    /** Loads a .hop file, turns on the run parameter and writes numBars bars to a wav file */
+    juce::Result render (const juce::File& presetFile, const juce::File& outputFile) const;
+
+    /** Same as above, but with state data that's already in memory */
+    juce::Result render (const juce::MemoryBlock& presetData, const juce::File& outputFile) const;
+
+    int64 getNumSamplesToRender() const;
+
+    const Settings& getSettings() const { return settings; }
+
+private:
+    /** Fixed tempo transport so the patch's sequencer follows the requested bpm from sample zero */
+    struct FixedTempoPlayHead : public juce::AudioPlayHead
+    {
+        juce::Optional<PositionInfo> getPosition() const override;
+
+        double bpm { 120.0 };
+        double sampleRate { 48000.0 };
+        int    beatsPerBar { 4 };
+        int64  samplePosition { 0 };
+    };
+
+    Settings settings;
+
+    static void setRunning (CustomAudioProcessor& processor, bool shouldRun);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
@@ -11,6 +11,7 @@
 #include "instance-management/TimedActionInstanceManager.h"
 #include "../../utilities/TimerAction.h"
 #include "../../utilities/multithreading/AtomicValue.h"
+#include "../../utilities/multithreading/SeqLockGroup.h"
 
 namespace nlt
 {
@@ -52,14 +53,7 @@ namespace NO_ACCESS
         APVTSCallbackInstanceManager()           = default;
         ~APVTSCallbackInstanceManager() override = default;
 
-        static void setOfflineMode (bool isOffline)
-        {
-            SharedResourcePointer<APVTSCallbackInstanceManager> m;
-            m->setOfflineModeInternal (isOffline);
-        }
-
     private:
-        void setOfflineModeInternal (bool isOffline);
         JUCE_LEAK_DETECTOR (APVTSCallbackInstanceManager)
     };
 
@@ -77,6 +71,10 @@ namespace NO_ACCESS
         ~APVTSCallbackInstance() override = default;
 
         void setOfflineMode (bool isOffline) override { ignoreUnused (isOffline); }
+
+    protected:
+        // first thing in every subclass' destructor, so a pass on another thread is done with it before it's torn down
+        void leaveInstanceManager() { removeFromInstanceManager(); }
     };
 
     struct APVTSCallbackSync : public APVTSCallbackInstance
@@ -87,7 +85,7 @@ namespace NO_ACCESS
         {
         }
 
-        ~APVTSCallbackSync() override = default;
+        ~APVTSCallbackSync() override { leaveInstanceManager(); }
 
         void setOfflineMode (bool isOffline) override { ignoreUnused (isOffline); }
 
@@ -114,7 +112,14 @@ namespace NO_ACCESS
         {
         }
 
-        ~APVTSCallbackGUI() override = default;
+        // stop the listener before the dirty list entry goes, the parameter can change on any thread
+        ~APVTSCallbackGUI() override
+        {
+            leaveInstanceManager();
+            parameter.removeListener (this);
+        }
+
+        static constexpr bool isUIOnly = true;
 
         void handleGlobalTimedAction()
         {
@@ -124,7 +129,11 @@ namespace NO_ACCESS
 
         void setOfflineMode (bool isOffline) override {}
 
-        void parameterValueChanged (int parameterIndex, float newValue) override { value = parameter.convertFrom0to1 (newValue); }
+        void parameterValueChanged (int parameterIndex, float newValue) override
+        {
+            value = parameter.convertFrom0to1 (newValue);
+            markDirty();
+        }
 
         void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {}
 
@@ -136,71 +145,171 @@ namespace NO_ACCESS
     struct APVTSCallbackAsync : public APVTSCallbackInstance, public TimedActionInstance<APVTSCallbackAsync, 60, 1>
     {
         template <typename Callback>
-        APVTSCallbackAsync (RangedAudioParameter& _parameter, Callback&& _callback)
+        APVTSCallbackAsync (RangedAudioParameter& _parameter, Callback&& _callback, const std::atomic<bool>& _offline)
             : APVTSCallbackInstance (_parameter, NLT_FWD (_callback))
+            , offline (_offline)
         {
         }
 
-        ~APVTSCallbackAsync() override = default;
+        // stop the listener before the dirty list entry goes, the parameter can change on any thread
+        ~APVTSCallbackAsync() override
+        {
+            leaveInstanceManager();
+            parameter.removeListener (this);
+        }
 
         void handleGlobalTimedAction()
         {
-            if (value.hasFreshValue())
+            if (!offline.load (std::memory_order_relaxed) && value.hasFreshValue())
                 callback (value.updateCurrent());
         }
 
-        void setOfflineMode (bool isOffline) override
+        // keeps the value while offline too, so a change from before the bounce can't land after the ones during it
+        void parameterValueChanged (int parameterIndex, float newValue) override
         {
-            if (isOffline)
-                parameter.removeListener (this);
-            else
-                parameter.addListener (this);
+            value = parameter.convertFrom0to1 (newValue);
+            if (!offline.load (std::memory_order_relaxed))
+                markDirty();
         }
 
-        void parameterValueChanged (int parameterIndex, float newValue) override { value = parameter.convertFrom0to1 (newValue); }
-
         void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {}
 
     private:
-        AtomicValue<float> value { 0.0f };
+        const std::atomic<bool>& offline;
+        AtomicValue<float>       value { 0.0f };
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (APVTSCallbackAsync)
     };
 
     struct APVTSCallbackAsyncOffline : public APVTSCallbackInstance
     {
         template <typename Callback>
-        APVTSCallbackAsyncOffline (RangedAudioParameter& _parameter, Callback&& _callback)
+        APVTSCallbackAsyncOffline (RangedAudioParameter& _parameter, Callback&& _callback, const std::atomic<bool>& _offline)
             : APVTSCallbackInstance (_parameter, NLT_FWD (_callback))
+            , offline (_offline)
         {
         }
 
-        ~APVTSCallbackAsyncOffline() override = default;
-
-        void setOfflineMode (bool isOffline) override
-        {
-            if (isOffline)
-                parameter.addListener (this);
-            else
-                parameter.removeListener (this);
-        }
+        ~APVTSCallbackAsyncOffline() override { leaveInstanceManager(); }
 
         void parameterValueChanged (int parameterIndex, float newValue) override
         {
-            callback (parameter.convertFrom0to1 (newValue));
+            if (offline.load (std::memory_order_relaxed))
+                callback (parameter.convertFrom0to1 (newValue));
         }
 
         void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {}
 
     private:
+        const std::atomic<bool>& offline;
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (APVTSCallbackAsyncOffline)
     };
 
-    inline void APVTSCallbackInstanceManager::setOfflineModeInternal (bool isOffline)
+    /**
+     * Calls back with the values of several parameters together, at most once per frame. The values go through a
+     * SeqLockGroup, so the callback never sees a group that's halfway through changing.
+     *
+     * Changes made while isHeld returns true, e.g. a preset's parameters arriving one at a time, are kept back and
+     * written to the group as one update once it returns false. Until then the callback keeps the values from before.
+     */
+    struct APVTSCallbackGroup : public AudioProcessorParameter::Listener, public TimedActionInstance<APVTSCallbackGroup, 60, 1>
     {
-        auto lock = APVTSCallbackInstanceManager::getInstancesLock();
-        for (auto& instance: APVTSCallbackInstanceManager::instances)
-            static_cast<APVTSCallbackBase*> (instance)->setOfflineMode (isOffline);
-    }
+        template <typename Callback>
+        APVTSCallbackGroup (const Array<RangedAudioParameter*>& _parameters, Callback&& _callback, std::function<bool()> _isHeld)
+            : parameters (_parameters)
+            , callback (NLT_FWD (_callback))
+            , isHeld (std::move (_isHeld))
+            , latest (static_cast<size_t> (_parameters.size()))
+            , values (static_cast<size_t> (_parameters.size()))
+            , snapshot (static_cast<size_t> (_parameters.size()))
+        {
+            {
+                SeqLockGroup<float>::ScopedWrite write (values);
+                for (int i = 0; i < parameters.size(); ++i)
+                {
+                    auto value = parameters[i]->convertFrom0to1 (parameters[i]->getValue());
+                    latest[static_cast<size_t> (i)].store (value, std::memory_order_relaxed);
+                    write.set (static_cast<size_t> (i), value);
+                }
+            }
+            values.read (snapshot, &lastVersion);
+            callback (snapshot);
+
+            for (auto* parameter: parameters)
+                parameter->addListener (this);
+        }
+
+        ~APVTSCallbackGroup() override
+        {
+            for (auto* parameter: parameters)
+                parameter->removeListener (this);
+        }
+
+        static constexpr bool isUIOnly = true;
+
+        void handleGlobalTimedAction()
+        {
+            if (isHeld != nullptr && isHeld())
+            {
+                // check again next frame, the hold ends without anything else marking this dirty
+                if (hasHeldValues.load (std::memory_order_relaxed))
+                    markDirty();
+            }
+            else if (hasHeldValues.exchange (false, std::memory_order_acquire))
+            {
+                SeqLockGroup<float>::ScopedWrite write (values);
+                for (size_t i = 0; i < latest.size(); ++i)
+                    write.set (i, latest[i].load (std::memory_order_relaxed));
+            }
+
+            uint32 version;
+            if (!values.read (snapshot, &version))
+            {
+                // a writer kept getting in the way, try again next frame
+                markDirty();
+                return;
+            }
+
+            if (version != lastVersion)
+            {
+                lastVersion = version;
+                callback (snapshot);
+            }
+        }
+
+        void parameterValueChanged (int parameterIndex, float newValue) override
+        {
+            for (int i = 0; i < parameters.size(); ++i)
+            {
+                if (parameters[i]->getParameterIndex() != parameterIndex)
+                    continue;
+
+                auto index = static_cast<size_t> (i);
+                auto value = parameters[i]->convertFrom0to1 (newValue);
+                latest[index].store (value, std::memory_order_relaxed);
+
+                if (isHeld != nullptr && isHeld())
+                    hasHeldValues.store (true, std::memory_order_release);
+                else
+                    values.set (index, value);
+            }
+            markDirty();
+        }
+
+        void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {}
+
+    private:
+        Array<RangedAudioParameter*>                     parameters;
+        std::function<void (const std::vector<float>&)> callback;
+        std::function<bool()>                            isHeld;
+        // every parameter's last value, including the ones held back
+        std::vector<std::atomic<float>> latest;
+        std::atomic<bool>               hasHeldValues { false };
+        SeqLockGroup<float>             values;
+        std::vector<float>              snapshot;
+        uint32                          lastVersion { 0 };
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (APVTSCallbackGroup)
+    };
 } // namespace NO_ACCESS
 
 /**
@@ -217,7 +326,14 @@ struct APVTSCallbacks
 
     ~APVTSCallbacks() = default;
 
-    void setOfflineMode (bool isOfflineMode) { NO_ACCESS::APVTSCallbackInstanceManager::setOfflineMode (isOfflineMode); }
+    /**
+     * Switches only the callbacks added here, so one processor bouncing leaves every other instance of the plugin alone.
+     * Any thread, e.g. the audio thread as soon as it sees the host is bouncing. The async callbacks check the mode each
+     * time their parameter changes, so the switch takes effect straight away.
+     */
+    void setOfflineMode (bool isOfflineMode) noexcept { offline.store (isOfflineMode, std::memory_order_relaxed); }
+
+    bool isOfflineMode() const noexcept { return offline.load (std::memory_order_relaxed); }
 
     enum Type
     {
@@ -272,11 +388,33 @@ struct APVTSCallbacks
     //        }
     //    }
 
-    void clear() { callbacks.clear(); }
+    /**
+     * Use this for GUI callbacks that need several parameters at once, e.g. drawing an envelope. The callback gets
+     * every value in the same order as the parameters, at most once per frame, and never a mix of old and new ones.
+     *
+     * @param isHeld    optional, called from any thread. While it returns true, changes are kept back and then
+     *                  passed on together, e.g. while a preset is being switched
+     */
+    template <typename CallbackFn>
+    void addGroup (const Array<RangedAudioParameter*>& parameters,
+                   CallbackFn&&                        callbackFn,
+                   std::function<bool()>               isHeld = nullptr)
+    {
+        groups.add (new NO_ACCESS::APVTSCallbackGroup (parameters, NLT_FWD (callbackFn), std::move (isHeld)));
+    }
+
+    void clear()
+    {
+        callbacks.clear();
+        groups.clear();
+    }
 
 private:
-    AudioProcessorValueTreeState*            apvts { nullptr };
-    OwnedArray<NO_ACCESS::APVTSCallbackBase> callbacks;
+    AudioProcessorValueTreeState*             apvts { nullptr };
+    // before the callbacks, which keep a reference to it
+    std::atomic<bool>                         offline { false };
+    OwnedArray<NO_ACCESS::APVTSCallbackBase>  callbacks;
+    OwnedArray<NO_ACCESS::APVTSCallbackGroup> groups;
 
     /**
      * Use this for any callbacks that need to happen synchronously e.g. processing
@@ -306,8 +444,9 @@ private:
      */
     void addAsyncCallback (RangedAudioParameter& info, std::function<void (float)> callbackFn)
     {
-        callbacks.add (new NO_ACCESS::APVTSCallbackAsync (info, callbackFn));
-        callbacks.add (new NO_ACCESS::APVTSCallbackAsyncOffline (info, callbackFn));
+        // both always listen, and each only calls back in its own mode
+        callbacks.add (new NO_ACCESS::APVTSCallbackAsync (info, callbackFn, offline));
+        callbacks.add (new NO_ACCESS::APVTSCallbackAsyncOffline (info, callbackFn, offline));
     }
 
     //    void addAsyncCallback (const String& paramID, std::function<void (float)> callbackFn)
@@ -85,6 +85,10 @@ public:
 
     const RangedAudioParameter& getParamInfo() const { return *parameter; }
 
+    RangedAudioParameter& getParameter() { return *parameter; }
+
+    Attachment& getAttachment() { return *attachment; }
+
 private:
     std::unique_ptr<Attachment> attachment;
     RangedAudioParameter*       parameter;
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    ParameterSenders.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+namespace nlt
+{
+using namespace juce;
+
+/**
+ * Where changes made in the UI to a parameter are sent, for processors that want them to reach their DSP some
+ * other way than setValueNotifyingHost, e.g. through a queue the audio thread drains. The attachments send to
+ * the parameter's sender if it has one, and fall back to setValueNotifyingHost if not.
+ *
+ * There's one per process, share it with a SharedResourcePointer. A processor adds its parameters' senders when
+ * it's built and removes them before anything they capture goes.
+ */
+struct ParameterSenders
+{
+    /** Takes the new normalised value */
+    using Sender = std::function<void (float)>;
+
+    ParameterSenders() = default;
+
+    void add (const RangedAudioParameter& parameter, Sender sender)
+    {
+        const ScopedLock sl (lock);
+        senders[&parameter] = std::move (sender);
+    }
+
+    void remove (const RangedAudioParameter& parameter)
+    {
+        const ScopedLock sl (lock);
+        senders.erase (&parameter);
+    }
+
+    /** Returns false if the parameter has no sender */
+    bool send (const RangedAudioParameter& parameter, float normalisedValue) const
+    {
+        const ScopedLock sl (lock);
+        auto             found = senders.find (&parameter);
+        if (found == senders.end())
+            return false;
+
+        found->second (normalisedValue);
+        return true;
+    }
+
+private:
+    CriticalSection                                         lock;
+    std::unordered_map<const RangedAudioParameter*, Sender> senders;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterSenders)
+};
+
+} // namespace nlt
@@ -10,6 +10,7 @@
 #pragma once
 #include "ParameterAttachment.h"
 #include "../APVTSCallback.h"
+#include "../ParameterSenders.h"
 #include "../../utilities/instance-management/TimedActionInstanceManager.h"
 #include "../../utilities/NLT_FWD.h"
 
@@ -24,27 +25,38 @@ struct APVTSParameterAttachment : public ParameterGUIAttachment, public TimedAct
         , parameter (_parameterInfo)
         , value (parameter.getValue())
     {
-        apvtsCallbacks.add (parameterInfo,
-                            APVTSCallbacks::Type::gui,
-                            [this] (float newValue)
-                            {
-                                value.store (parameter.convertTo0to1 (newValue));
-                                updatedFromAutomation.store (true);
-                            });
+        followParameter();
         //        value.store (parameter.getValue());
         //        updatedFromAutomation.store (true);
     }
 
+    /**
+     * Stops passing parameter changes on to the attached element, for when something else keeps it up to date,
+     * e.g. an APVTSCallbacks group. Changes from the element still reach the parameter.
+     */
+    void setFollowsParameter (bool shouldFollow)
+    {
+        apvtsCallbacks.clear();
+        if (shouldFollow)
+            followParameter();
+    }
+
+    static constexpr bool isUIOnly = true;
+
     void handleGlobalTimedAction()
     {
-        if (!ignoreCallbacks)
+        if (ignoreCallbacks)
         {
-            if (updatedFromAttachedElement.exchange (false))
-                setValueAsCompleteGesture (parameter.convertFrom0to1 (value.load()));
-
-            if (updatedFromAutomation.exchange (false))
-                callback (parameter.convertFrom0to1 (value.load()));
+            // try again next tick, nothing else will mark this
+            markDirty();
+            return;
         }
+
+        if (updatedFromAttachedElement.exchange (false))
+            setValueAsCompleteGesture (parameter.convertFrom0to1 (value.load()));
+
+        if (updatedFromAutomation.exchange (false))
+            callback (parameter.convertFrom0to1 (value.load()));
     }
 
     /** Triggers a full gesture message on the managed parameter.
@@ -58,7 +70,7 @@ struct APVTSParameterAttachment : public ParameterGUIAttachment, public TimedAct
                                      [this] (float f)
                                      {
                                          beginGesture();
-                                         parameter.setValueNotifyingHost (parameter.convertTo0to1 (f));
+                                         sendValue (parameter.convertTo0to1 (f));
                                          endGesture();
                                      });
     }
@@ -81,7 +93,7 @@ struct APVTSParameterAttachment : public ParameterGUIAttachment, public TimedAct
                                      [this] (float f)
                                      {
                                          parameter.beginChangeGesture();
-                                         parameter.setValueNotifyingHost (f);
+                                         sendValue (f);
                                          parameter.endChangeGesture();
                                      });
     }
@@ -97,12 +109,14 @@ struct APVTSParameterAttachment : public ParameterGUIAttachment, public TimedAct
     {
         value.store (parameter.convertTo0to1 (newValue));
         updatedFromAttachedElement.store (true);
+        markDirty();
     }
 
     void setValueFromAttached (const String& text) override
     {
         value.store (parameter.convertTo0to1 (getValueFromText (text)));
         updatedFromAttachedElement.store (true);
+        markDirty();
     }
 
 private:
@@ -111,8 +125,29 @@ private:
     std::atomic<bool>     updatedFromAutomation { false };
     APVTSCallbacks        apvtsCallbacks;
 
+    SharedResourcePointer<ParameterSenders> senders;
+
+    /** To the processor's own sender if it has one, the parameter follows once the processor has the value */
+    void sendValue (float normalisedValue)
+    {
+        if (!senders->send (parameter, normalisedValue))
+            parameter.setValueNotifyingHost (normalisedValue);
+    }
+
     float normalise (float f) const { return parameter.convertTo0to1 (f); }
 
+    void followParameter()
+    {
+        apvtsCallbacks.add (parameterInfo,
+                            APVTSCallbacks::Type::gui,
+                            [this] (float newValue)
+                            {
+                                value.store (parameter.convertTo0to1 (newValue));
+                                updatedFromAutomation.store (true);
+                                markDirty();
+                            });
+    }
+
     template <typename Callback>
     void callIfParameterValueChanged (float newDenormalisedValue, Callback&& callback)
     {
@@ -39,10 +39,10 @@ struct APVTSSliderAttachment
     /** Destructor. */
     ~APVTSSliderAttachment() = default;
 
-private:
-    nlt::Slider&             slider;
-    APVTSParameterAttachment attachment;
+    /** @see APVTSParameterAttachment::setFollowsParameter */
+    void setFollowsParameter (bool shouldFollow) { attachment.setFollowsParameter (shouldFollow); }
 
+    /** Moves the slider to a parameter value without sending it back to the parameter */
     void setValue (float newValue)
     {
         auto scopedIgnore = attachment.getScopedIgnoreCallbacks();
@@ -50,6 +50,10 @@ private:
         slider.valueChanged();
     }
 
+private:
+    nlt::Slider&             slider;
+    APVTSParameterAttachment attachment;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (APVTSSliderAttachment)
 };
 
@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+#include <numeric>
+
+using namespace juce;
+
+namespace
+{
+    template <typename Type>
+    Type readLE (const char* p) noexcept
+    {
+        Type value;
+        memcpy (&value, p, sizeof (Type));
+        return ByteOrder::swapIfBigEndian (value);
+    }
+
+    /** "kicks\\Boom.hop" -> "kicks/Boom" */
+    String nameFromPath (const String& relativePath)
+    {
+        auto path = relativePath.replaceCharacter ('\\', '/');
+        return path.fromLastOccurrenceOf ("/", false, false).containsChar ('.')
+                   ? path.upToLastOccurrenceOf (".", false, false)
+                   : path;
+    }
+} // namespace
+
+PresetBank::PresetBank (const File& bankFile)
+    : file (bankFile)
+    , map (std::make_unique<MemoryMappedFile> (bankFile, MemoryMappedFile::readOnly))
+{
+    auto* data = static_cast<const char*> (map->getData());
+    auto  size = map->getSize();
+
+    if (data == nullptr || size < headerSize || readLE<uint32> (data) != magic || readLE<uint16> (data + 4) > version)
+    {
+        map.reset();
+        return;
+    }
+
+    auto count = readLE<uint32> (data + 8);
+    if (!isInRange (headerSize, (uint64) count * recordSize))
+    {
+        map.reset();
+        return;
+    }
+
+    numPresets = static_cast<int> (count);
+    indexByName.reserve (count);
+    for (auto i = 0; i < numPresets; ++i)
+        indexByName.emplace (getName (i), i);
+}
+
+bool PresetBank::isInRange (uint64 offset, uint64 size) const noexcept
+{
+    auto total = (uint64) map->getSize();
+    return offset <= total && size <= total - offset;
+}
+
+const char* PresetBank::getRecord (int index) const noexcept
+{
+    if (!isValid() || !isPositiveAndBelow (index, numPresets))
+        return nullptr;
+    return static_cast<const char*> (map->getData()) + headerSize + (size_t) index * recordSize;
+}
+
+String PresetBank::getName (int index) const
+{
+    auto* record = getRecord (index);
+    if (record == nullptr)
+        return {};
+
+    auto offset = readLE<uint64> (record);
+    auto size   = readLE<uint32> (record + 8);
+    if (!isInRange (offset, size))
+        return {};
+
+    return String::fromUTF8 (static_cast<const char*> (map->getData()) + offset, (int) size);
+}
+
+bool PresetBank::getPreset (int index, const void*& data, size_t& sizeInBytes) const
+{
+    auto* record = getRecord (index);
+    if (record == nullptr)
+        return false;
+
+    auto offset = readLE<uint64> (record + 16);
+    auto size   = readLE<uint64> (record + 24);
+    if (!isInRange (offset, size))
+        return false;
+
+    data        = static_cast<const char*> (map->getData()) + offset;
+    sizeInBytes = (size_t) size;
+    return true;
+}
+
+int PresetBank::indexOf (const String& name) const
+{
+    auto found = indexByName.find (name);
+    return found == indexByName.end() ? -1 : found->second;
+}
+
+//==============================================================================
+
+std::shared_ptr<const PresetBank> PresetBank::open (const File& bankFile)
+{
+    struct Opened
+    {
+        Time                            modified;
+        std::weak_ptr<const PresetBank> bank;
+    };
+    static CriticalSection          lock;
+    static std::map<String, Opened> opened;
+
+    auto modified = bankFile.getLastModificationTime();
+
+    const ScopedLock sl (lock);
+    for (auto it = opened.begin(); it != opened.end();)
+        it = it->second.bank.expired() ? opened.erase (it) : std::next (it);
+
+    auto& entry = opened[bankFile.getFullPathName()];
+    if (auto bank = entry.bank.lock(); bank != nullptr && entry.modified == modified)
+        return bank;
+
+    auto bank = std::make_shared<const PresetBank> (bankFile);
+    if (!bank->isValid())
+        return nullptr;
+
+    entry = { modified, bank };
+    return bank;
+}
+
+File PresetBank::findBankFor (const File& f)
+{
+    for (auto parent = f.getParentDirectory(); parent != parent.getParentDirectory(); parent = parent.getParentDirectory())
+        if (parent.hasFileExtension (fileExtension))
+            return parent.existsAsFile() ? parent : File();
+    return {};
+}
+
+bool PresetBank::loadPreset (const File& f, MemoryBlock& dest)
+{
+    auto bankFile = findBankFor (f);
+    if (bankFile == File())
+        return f.loadFileAsData (dest);
+
+    auto bank = open (bankFile);
+    if (bank == nullptr)
+        return false;
+
+    const void* data;
+    size_t      size;
+    // not getRelativePathFrom(), that would treat the bank as a file and go from its parent folder
+    auto name = nameFromPath (f.getFullPathName().substring (bankFile.getFullPathName().length() + 1));
+    if (!bank->getPreset (bank->indexOf (name), data, size))
+        return false;
+
+    dest.replaceAll (data, size);
+    return true;
+}
+
+Result PresetBank::exportFolder (const File& folder, const String& presetExtension, const File& bankFile)
+{
+    auto presets = folder.findChildFiles (File::findFiles, true, "*." + presetExtension.trimCharactersAtStart ("."));
+    if (presets.isEmpty())
+        return Result::fail ("no presets in " + folder.getFullPathName());
+
+    StringArray names;
+    for (auto& p: presets)
+        names.add (nameFromPath (p.getRelativePathFrom (folder)));
+
+    // sort the presets the same way the preset menu does, so the index is in menu order
+    std::vector<int> order ((size_t) presets.size());
+    std::iota (order.begin(), order.end(), 0);
+    std::sort (order.begin(),
+               order.end(),
+               [&names] (int a, int b) { return names[a].compareNatural (names[b]) < 0; });
+
+    TemporaryFile temp (bankFile);
+    {
+        FileOutputStream out (temp.getFile());
+        if (!out.openedOk())
+            return Result::fail ("couldn't write " + bankFile.getFullPathName());
+
+        out.writeInt ((int) magic);
+        out.writeShort ((short) version);
+        out.writeShort (0);
+        out.writeInt (presets.size());
+        out.writeInt (0);
+
+        // index is filled in once the data offsets are known
+        auto indexStart = out.getPosition();
+        for (size_t i = 0; i < (size_t) presets.size() * recordSize; ++i)
+            out.writeByte (0);
+
+        std::vector<std::pair<int64, int>> nameRecords;
+        for (auto i: order)
+        {
+            auto utf8 = names[i].toUTF8();
+            auto size = (int) utf8.sizeInBytes() - 1;
+            nameRecords.emplace_back (out.getPosition(), size);
+            out.write (utf8.getAddress(), (size_t) size);
+        }
+
+        std::vector<std::pair<int64, int64>> dataRecords;
+        for (auto i: order)
+        {
+            while (out.getPosition() % 8 != 0)
+                out.writeByte (0);
+
+            MemoryBlock data;
+            if (!presets[i].loadFileAsData (data))
+                return Result::fail ("couldn't read " + presets[i].getFullPathName());
+            dataRecords.emplace_back (out.getPosition(), (int64) data.getSize());
+            out.write (data.getData(), data.getSize());
+        }
+
+        out.setPosition (indexStart);
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            out.writeInt64 (nameRecords[i].first);
+            out.writeInt (nameRecords[i].second);
+            out.writeInt (0);
+            out.writeInt64 (dataRecords[i].first);
+            out.writeInt64 (dataRecords[i].second);
+        }
+
+        out.flush();
+        if (out.getStatus().failed())
+            return out.getStatus();
+    }
+
+    return temp.overwriteTargetFileWithTemporary() ? Result::ok()
+                                                   : Result::fail ("couldn't write " + bankFile.getFullPathName());
+}
+
+Result PresetBank::importToFolder (const File& bankFile, const File& folder, const String& presetExtension)
+{
+    PresetBank bank (bankFile);
+    if (!bank.isValid())
+        return Result::fail (bankFile.getFullPathName() + " isn't a preset bank");
+
+    for (auto i = 0; i < bank.getNumPresets(); ++i)
+    {
+        const void* data;
+        size_t      size;
+        if (!bank.getPreset (i, data, size))
+            return Result::fail ("preset " + String (i) + " in " + bankFile.getFullPathName() + " is damaged");
+
+        auto preset = folder.getChildFile (bank.getName (i) + "." + presetExtension.trimCharactersAtStart ("."));
+        // the names come from the file, so don't let one like ../../x write outside the folder
+        if (!preset.isAChildOf (folder))
+            return Result::fail ("preset " + String (i) + " in " + bankFile.getFullPathName() + " has a name outside the folder");
+
+        preset.getParentDirectory().createDirectory();
+        if (!preset.replaceWithData (data, size))
+            return Result::fail ("couldn't write " + preset.getFullPathName());
+    }
+    return Result::ok();
+}
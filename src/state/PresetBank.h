@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "JuceHeader.h"
+
+/**
+ * Lots of presets in one file, read through a memory map.
+ *
+ * layout:  header | index | names | preset data
+ *
+ *          header  magic "CHPB" (uint32) | version (uint16) | reserved (uint16) | numPresets (uint32) | reserved (uint32)
+ *          index   one fixed size record per preset: nameOffset (uint64) | nameSize (uint32) | reserved (uint32)
+ *                  | dataOffset (uint64) | dataSize (uint64)
+ *
+ * All little endian, offsets are from the start of the file. Finding preset n is just a read of
+ * record n, and its data is used straight out of the mapped file. Each preset's data is exactly
+ * what the equivalent .hop file holds, and its name is its path relative to the folder it was
+ * exported from, with '/' separators and no extension.
+ *
+ * Presets inside a bank are addressed as if the bank was a folder, e.g. Drums.hopbank/kicks/Boom.hop,
+ * and loadPreset() reads either kind.
+ */
+struct PresetBank
+{
+    static constexpr const char* fileExtension = "hopbank";
+
+    /** Maps the file. Check isValid() before using it */
+    explicit PresetBank (const juce::File& bankFile);
+
+    bool isValid() const noexcept { return map != nullptr; }
+
+    const juce::File& getFile() const noexcept { return file; }
+
+    int getNumPresets() const noexcept { return numPresets; }
+
+    juce::String getName (int index) const;
+
+    /** Points data at the preset inside the mapped file. Only valid for as long as the bank is */
+    bool getPreset (int index, const void*& data, size_t& sizeInBytes) const;
+
+    /** Returns -1 if there's no preset with this name */
+    int indexOf (const juce::String& name) const;
+
+    //==============================================================================
+
+    /**
+     * Returns the bank, shared with anyone else who has it open and unmapped once nobody does. It's
+     * reopened if the file has changed. Hold onto it to keep it mapped between reads, e.g. for a batch.
+     */
+    static std::shared_ptr<const PresetBank> open (const juce::File& bankFile);
+
+    /** If file is a preset inside a bank, returns the bank file. Otherwise returns {} */
+    static juce::File findBankFor (const juce::File& file);
+
+    /** Reads a preset, either a file on disk or one inside a bank */
+    static bool loadPreset (const juce::File& file, juce::MemoryBlock& dest);
+
+    /** Writes every preset under folder (with presetExtension) into a bank, keeping the folder layout in the names */
+    static juce::Result exportFolder (const juce::File& folder, const juce::String& presetExtension, const juce::File& bankFile);
+
+    /**
+     * Writes every preset in the bank out as a file under folder, recreating the folder layout.
+     * Fails if a name would put a preset outside folder.
+     */
+    static juce::Result importToFolder (const juce::File& bankFile, const juce::File& folder, const juce::String& presetExtension);
+
+private:
+    static constexpr juce::uint32 magic      = 0x42504843; // "CHPB" little endian
+    static constexpr juce::uint16 version    = 1;
+    static constexpr size_t       headerSize = 16;
+    static constexpr size_t       recordSize = 32;
+
+    juce::File                              file;
+    std::unique_ptr<juce::MemoryMappedFile> map;
+    int                                     numPresets { 0 };
+    std::unordered_map<juce::String, int>   indexByName;
+
+    const char* getRecord (int index) const noexcept;
+    bool        isInRange (juce::uint64 offset, juce::uint64 size) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBank)
+};
@@ -0,0 +1,358 @@
+/*
+  ==============================================================================
+
+    PresetSwitcher.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetSwitcher.h"
+
+using namespace juce;
+
+std::unique_ptr<PreparedState> PreparedState::fromData (const void* data, size_t sizeInBytes)
+{
+    nlohmann::json presetJSON;
+    auto           state = std::make_unique<PreparedState>();
+    if (!ChippoState::read (data, sizeInBytes, presetJSON, state->metadata))
+        return nullptr;
+
+    state->preset = RNBO::convertJSONObjToPreset (presetJSON);
+    state->data.replaceAll (data, sizeInBytes);
+    return state;
+}
+
+PresetSwitcher::Worker::Worker()
+    : Thread ("Chippo preset switcher")
+{
+    startThread (Thread::Priority::normal);
+}
+
+PresetSwitcher::Worker::~Worker()
+{
+    stopThread (audioTimeoutMs * 2);
+}
+
+void PresetSwitcher::Worker::add (PresetSwitcher* switcher)
+{
+    const ScopedLock sl (lock);
+    switchers.push_back (switcher);
+}
+
+void PresetSwitcher::Worker::remove (PresetSwitcher* switcher)
+{
+    const ScopedLock sl (lock);
+    switchers.erase (std::remove (switchers.begin(), switchers.end(), switcher), switchers.end());
+}
+
+void PresetSwitcher::Worker::run()
+{
+    while (!threadShouldExit())
+    {
+        auto isWaitingOnAudio = false;
+        {
+            const ScopedLock sl (lock);
+            for (auto* switcher: switchers)
+                isWaitingOnAudio = switcher->step() || isWaitingOnAudio;
+        }
+
+        // polled rather than signalled while fading, so the audio thread never has to touch a lock
+        wait (isWaitingOnAudio ? 1 : -1);
+    }
+}
+
+PresetSwitcher::PresetSwitcher (RNBO::CoreObject& rnboObject, MetadataFn onMetadata, std::function<void()> onSwitched)
+    : rnbo (rnboObject)
+    , metadataFn (std::move (onMetadata))
+    , switchedFn (std::move (onSwitched))
+{
+}
+
+PresetSwitcher::~PresetSwitcher()
+{
+    stop();
+}
+
+void PresetSwitcher::stop()
+{
+    {
+        const ScopedLock lock (workerLock);
+        if (worker != nullptr)
+            (*worker)->remove (this);
+        worker.reset();
+    }
+    cancelPendingUpdate();
+}
+
+void PresetSwitcher::wakeWorker()
+{
+    const ScopedLock lock (workerLock);
+    if (worker == nullptr)
+    {
+        worker = std::make_unique<SharedResourcePointer<Worker>>();
+        (*worker)->add (this);
+    }
+    (*worker)->wake();
+}
+
+void PresetSwitcher::load (const void* data, size_t sizeInBytes)
+{
+    {
+        const ScopedLock lock (pendingLock);
+        pendingData.replaceAll (data, sizeInBytes);
+        hasPendingData = true;
+        pendingState.reset();
+        latestData.replaceAll (data, sizeInBytes);
+        ++numLoaded;
+        switching.store (true, std::memory_order_release);
+    }
+    wakeWorker();
+}
+
+void PresetSwitcher::load (std::unique_ptr<PreparedState> state)
+{
+    jassert (state != nullptr);
+    {
+        const ScopedLock lock (pendingLock);
+        latestData     = state->data;
+        pendingState   = std::move (state);
+        hasPendingData = false;
+        pendingData.reset();
+        ++numLoaded;
+        switching.store (true, std::memory_order_release);
+    }
+    wakeWorker();
+}
+
+void PresetSwitcher::applySync (std::unique_ptr<PreparedState> state)
+{
+    jassert (state != nullptr);
+
+    uint64 loadNumber;
+    {
+        const ScopedLock lock (pendingLock);
+        latestData     = state->data;
+        hasPendingData = false;
+        pendingData.reset();
+        pendingState.reset();
+        syncPreset.reset();
+        loadNumber  = ++numLoaded;
+        numSwitched = loadNumber;
+        switching.store (true, std::memory_order_release);
+    }
+
+    setLoadedMetadata (state->metadata, loadNumber);
+    if (metadataFn != nullptr)
+        metadataFn (state->metadata);
+
+    rnbo.setPresetSync (std::move (state->preset));
+    // if a fade was cut short, the audio thread stays silent until it's told the new preset is in
+    if (stage.load (std::memory_order_acquire) != idle)
+        stage.store (switched, std::memory_order_release);
+
+    hasSwitched.store (false, std::memory_order_relaxed);
+    if (switchedFn != nullptr)
+        switchedFn();
+    updateSwitching();
+}
+
+bool PresetSwitcher::isSuperseded (uint64 loadNumber) const
+{
+    const ScopedLock lock (pendingLock);
+    return loadNumber < numLoaded;
+}
+
+void PresetSwitcher::setLoadedMetadata (const ChippoState::Metadata& metadata, uint64 loadNumber)
+{
+    const ScopedLock lock (metadataLock);
+    if (loadNumber < metadataLoadNumber)
+        return;
+
+    loadedMetadata     = metadata;
+    metadataLoadNumber = loadNumber;
+}
+
+void PresetSwitcher::updateSwitching()
+{
+    const ScopedLock lock (pendingLock);
+    if (numSwitched >= numLoaded)
+        switching.store (false, std::memory_order_release);
+}
+
+bool PresetSwitcher::canSwitchInBackground() const noexcept
+{
+    auto last = lastBlockMs.load (std::memory_order_relaxed);
+    return !nonRealtime.load (std::memory_order_relaxed) && last != 0
+           && Time::getMillisecondCounter() - last < audioStoppedMs;
+}
+
+bool PresetSwitcher::getPendingState (MemoryBlock& dest) const
+{
+    const ScopedLock lock (pendingLock);
+    if (numSwitched >= numLoaded)
+        return false;
+
+    dest = latestData;
+    return true;
+}
+
+void PresetSwitcher::prepare (double sampleRate) noexcept
+{
+    gainStep = 1.0f / static_cast<float> (jmax (1.0, fadeLengthSeconds * sampleRate));
+}
+
+void PresetSwitcher::blockStarted (bool isNonRealtime) noexcept
+{
+    nonRealtime.store (isNonRealtime, std::memory_order_relaxed);
+    lastBlockMs.store (Time::getMillisecondCounter(), std::memory_order_relaxed);
+}
+
+bool PresetSwitcher::step()
+{
+    // anything newly loaded replaces whatever was in progress, only the latest is ever decoded
+    startSwitch();
+
+    if (task == waitingForSilence)
+    {
+        if (isSuperseded (taskLoadNumber))
+        {
+            // a newer state was applied straight away meanwhile, let the audio fade back in to that
+            fadingPreset.reset();
+            stage.store (switched, std::memory_order_release);
+            task = noTask;
+        }
+        else if (stage.load (std::memory_order_acquire) == silent)
+        {
+            rnbo.setPreset (std::move (fadingPreset));
+            stage.store (switched, std::memory_order_release);
+            task = waitingForBlock;
+        }
+        else if (Time::getMillisecondCounter() > fadeTimeoutMs)
+        {
+            // the audio stopped while fading, nothing is left to take it at a block boundary
+            switchOnMessageThread (std::move (fadingPreset), taskLoadNumber);
+            task = noTask;
+        }
+    }
+
+    // RNBO only has it once the audio thread has been through a block, until then it's still pending
+    if (task == waitingForBlock && stage.load (std::memory_order_acquire) != switched)
+    {
+        finishSwitch (taskLoadNumber);
+        task = noTask;
+    }
+
+    return task != noTask;
+}
+
+void PresetSwitcher::startSwitch()
+{
+    MemoryBlock                    data;
+    std::unique_ptr<PreparedState> state;
+    uint64                         loadNumber = 0;
+    bool                           isMessageThreadSwitching;
+    {
+        const ScopedLock lock (pendingLock);
+        if (!hasPendingData && pendingState == nullptr)
+            return;
+        data.swapWith (pendingData);
+        hasPendingData           = false;
+        state                    = std::move (pendingState);
+        loadNumber               = numLoaded;
+        isMessageThreadSwitching = syncPreset != nullptr;
+    }
+
+    if (state == nullptr)
+        state = PreparedState::fromData (data.getData(), data.getSize());
+    if (state == nullptr)
+    {
+        jassertfalse; // couldn't make sense of this state, so it's no longer pending and the current one stays
+        {
+            const ScopedLock lock (pendingLock);
+            numSwitched = jmax (numSwitched, loadNumber);
+        }
+        triggerAsyncUpdate();
+        return;
+    }
+
+    setLoadedMetadata (state->metadata, loadNumber);
+    triggerAsyncUpdate();
+
+    // if the message thread already has one to apply, this replaces it rather than racing it
+    if (isMessageThreadSwitching || !canSwitchInBackground())
+    {
+        fadingPreset.reset();
+        task = noTask;
+        switchOnMessageThread (std::move (state->preset), loadNumber);
+        return;
+    }
+
+    // already faded out, or fading, and if the last one was handed over already the audio thread goes quiet again
+    if (task != waitingForSilence)
+    {
+        stage.store (fadingOut, std::memory_order_release);
+        fadeTimeoutMs = Time::getMillisecondCounter() + (uint32) audioTimeoutMs;
+    }
+
+    fadingPreset   = std::move (state->preset);
+    taskLoadNumber = loadNumber;
+    task           = waitingForSilence;
+}
+
+void PresetSwitcher::switchOnMessageThread (RNBO::UniquePresetPtr preset, uint64 loadNumber)
+{
+    {
+        const ScopedLock lock (pendingLock);
+        syncPreset     = std::move (preset);
+        syncLoadNumber = loadNumber;
+    }
+    triggerAsyncUpdate();
+}
+
+void PresetSwitcher::finishSwitch (uint64 loadNumber)
+{
+    {
+        const ScopedLock lock (pendingLock);
+        numSwitched = jmax (numSwitched, loadNumber);
+    }
+
+    // not from the worker, where it would hold up every other instance's switches
+    hasSwitched.store (true, std::memory_order_release);
+    triggerAsyncUpdate();
+}
+
+void PresetSwitcher::handleAsyncUpdate()
+{
+    ChippoState::Metadata metadata;
+    {
+        const ScopedLock lock (metadataLock);
+        metadata = loadedMetadata;
+    }
+
+    if (metadataFn != nullptr)
+        metadataFn (metadata);
+
+    RNBO::UniquePresetPtr preset;
+    uint64                loadNumber = 0;
+    {
+        const ScopedLock lock (pendingLock);
+        // one loaded since is either on its way or already in, applying this now would put an older state back
+        if (syncLoadNumber >= numLoaded)
+            preset = std::move (syncPreset);
+        syncPreset.reset();
+        loadNumber = syncLoadNumber;
+    }
+
+    if (preset != nullptr)
+    {
+        rnbo.setPresetSync (std::move (preset));
+        // if a fade was cut short, the audio thread stays silent until it's told the new preset is in
+        if (stage.load (std::memory_order_acquire) != idle)
+            stage.store (switched, std::memory_order_release);
+        finishSwitch (loadNumber);
+    }
+
+    if (hasSwitched.exchange (false, std::memory_order_acquire) && switchedFn != nullptr)
+        switchedFn();
+    updateSwitching();
+}
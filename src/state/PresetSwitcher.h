@@ -0,0 +1,230 @@
+/*
+  ==============================================================================
+
+    PresetSwitcher.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "JuceHeader.h"
+#include "RNBO.h"
+#include "StateFormat.h"
+
+/** A state decoded ahead of time, so applying it involves no parsing */
+struct PreparedState
+{
+    RNBO::UniquePresetPtr preset;
+    ChippoState::Metadata metadata;
+    /** what it was decoded from, so it can be handed back as the state until it's been applied */
+    juce::MemoryBlock data;
+
+    /** Decodes either ChippoState format. Returns nullptr if the data can't be read. Safe to call from any thread */
+    static std::unique_ptr<PreparedState> fromData (const void* data, size_t sizeInBytes);
+};
+
+/**
+ * Switches presets without blocking or allocating on the audio thread.
+ *
+ * load() copies the state and wakes a background thread, which decodes it and asks the audio thread
+ * to fade out. Once the output is silent the background thread hands the preset to RNBO's own event
+ * queue (setPreset), which applies it at the start of the next block, and the audio thread fades back in.
+ * The audio thread only ever touches a couple of atomics and a gain. If the audio stops before it gets
+ * there, the preset goes to the message thread to be applied with setPresetSync instead, RNBO's sync
+ * preset calls are never made from the background thread.
+ *
+ * Every instance shares the one background thread. It never waits on any single instance's audio, it
+ * checks on each switch in progress every millisecond and sleeps when there are none. An instance only
+ * joins it, starting it if need be, the first time it loads a state, so offline renders never do.
+ *
+ * Loading again before a switch has finished replaces the pending state, so scrolling through presets
+ * only ever applies the last one. Until the last one loaded has been applied, getPendingState() hands it
+ * back, so a host asking for the state straight after setting it gets what it set. A state applied with
+ * applySync() counts as loaded too, so nothing loaded before it is applied afterwards.
+ */
+struct PresetSwitcher : private juce::AsyncUpdater
+{
+    using MetadataFn = std::function<void (const ChippoState::Metadata&)>;
+
+    /**
+     * @param onMetadata    called on the message thread with the metadata of every loaded state
+     * @param onSwitched    called on the message thread once RNBO has applied a new preset
+     */
+    PresetSwitcher (RNBO::CoreObject& rnboObject, MetadataFn onMetadata, std::function<void()> onSwitched);
+    ~PresetSwitcher() override;
+
+    /** Leaves the shared worker and cancels any callbacks still to come. Call this before the callbacks' targets go */
+    void stop();
+
+    /** Queues a state (either ChippoState format) to switch to. The data is copied */
+    void load (const void* data, size_t sizeInBytes);
+
+    /** Queues an already decoded state to switch to */
+    void load (std::unique_ptr<PreparedState> state);
+
+    /**
+     * Applies a state straight away with setPresetSync, replacing anything still to be switched to. Only for when the
+     * audio isn't running, from the thread the state is set on, and onMetadata and onSwitched are called from it too.
+     */
+    void applySync (std::unique_ptr<PreparedState> state);
+
+    /** True if the audio thread is running in realtime, so a switch can be faded */
+    bool canSwitchInBackground() const noexcept;
+
+    /** If a loaded state hasn't been applied yet, copies it into dest and returns true. Any thread */
+    bool getPendingState (juce::MemoryBlock& dest) const;
+
+    /**
+     * True from the moment a state is loaded until onSwitched has returned for the latest one, so everything the
+     * preset changes has arrived by the time it goes false. Any thread
+     */
+    bool isSwitching() const noexcept { return switching.load (std::memory_order_acquire); }
+
+    // audio thread ===================================================================
+
+    void prepare (double sampleRate) noexcept;
+
+    /** Call at the top of processBlock */
+    void blockStarted (bool isNonRealtime) noexcept;
+
+    /** Call at the end of processBlock, applies the fade to the output */
+    template <typename SampleType>
+    void applyFade (juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+private:
+    enum Stage
+    {
+        idle = 0,
+        fadingOut,
+        silent,
+        switched,
+        fadingIn
+    };
+
+    /** The thread every PresetSwitcher's switches run on */
+    struct Worker : private juce::Thread
+    {
+        Worker();
+        ~Worker() override;
+
+        void add (PresetSwitcher* switcher);
+        void remove (PresetSwitcher* switcher);
+        void wake() { notify(); }
+
+    private:
+        // held while a switcher is stepped, so removing one waits for it to finish
+        juce::CriticalSection        lock;
+        std::vector<PresetSwitcher*> switchers;
+
+        void run() override;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Worker)
+    };
+
+    static constexpr double fadeLengthSeconds = 0.01;
+    /** how long to wait for the audio thread to fade out before giving up and switching anyway */
+    static constexpr int audioTimeoutMs = 200;
+    /** the audio thread counts as stopped if it hasn't processed a block for this long */
+    static constexpr juce::uint32 audioStoppedMs = 100;
+
+    RNBO::CoreObject&     rnbo;
+    MetadataFn            metadataFn;
+    std::function<void()> switchedFn;
+    // the shared worker, from the first load on
+    juce::CriticalSection                                workerLock;
+    std::unique_ptr<juce::SharedResourcePointer<Worker>> worker;
+
+    // only the latest of these is ever applied, loading one clears the other
+    mutable juce::CriticalSection  pendingLock;
+    juce::MemoryBlock              pendingData;
+    bool                           hasPendingData { false };
+    std::unique_ptr<PreparedState> pendingState;
+    // the last state loaded, which is the state until numSwitched catches up with numLoaded
+    juce::MemoryBlock latestData;
+    juce::uint64      numLoaded { 0 };
+    juce::uint64      numSwitched { 0 };
+    // waiting for the message thread to apply it, because the audio wasn't running to take it
+    RNBO::UniquePresetPtr syncPreset;
+    juce::uint64          syncLoadNumber { 0 };
+
+    juce::CriticalSection metadataLock;
+    ChippoState::Metadata loadedMetadata;
+    juce::uint64          metadataLoadNumber { 0 };
+    // set once RNBO has a new preset, so onSwitched is called from the message thread
+    std::atomic<bool> hasSwitched { false };
+    // set under pendingLock with every load, and cleared on the message thread once the latest is in
+    std::atomic<bool> switching { false };
+
+    std::atomic<int>          stage { idle };
+    std::atomic<juce::uint32> lastBlockMs { 0 };
+    std::atomic<bool>         nonRealtime { false };
+    float                     gain { 1.0f };
+    float                     gainStep { 1.0f / 480.0f };
+
+    // the worker's progress through a switch, worker thread only
+    enum Task
+    {
+        noTask = 0,
+        waitingForSilence,
+        waitingForBlock
+    };
+
+    Task                  task { noTask };
+    RNBO::UniquePresetPtr fadingPreset;
+    juce::uint64          taskLoadNumber { 0 };
+    juce::uint32          fadeTimeoutMs { 0 };
+
+    void handleAsyncUpdate() override;
+
+    /** True if a state has been loaded since this one. Takes pendingLock */
+    bool isSuperseded (juce::uint64 loadNumber) const;
+    void setLoadedMetadata (const ChippoState::Metadata& metadata, juce::uint64 loadNumber);
+    /** Clears switching if nothing loaded is still to be applied. Takes pendingLock */
+    void updateSwitching();
+
+    /** Joins the shared worker if this hasn't already, and wakes it */
+    void wakeWorker();
+
+    /** Worker thread, moves the switch along. Returns true while it's waiting on the audio thread */
+    bool step();
+    void startSwitch();
+    void switchOnMessageThread (RNBO::UniquePresetPtr preset, juce::uint64 loadNumber);
+    void finishSwitch (juce::uint64 loadNumber);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetSwitcher)
+};
+
+template <typename SampleType>
+void PresetSwitcher::applyFade (juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    auto current = stage.load (std::memory_order_acquire);
+    if (current == idle)
+        return;
+
+    auto numSamples  = buffer.getNumSamples();
+    auto numChannels = buffer.getNumChannels();
+
+    if (current == silent || current == switched)
+    {
+        // RNBO applies the preset at the start of the block after it was handed over, so stay
+        // silent through this one and only fade in once the new preset is definitely playing
+        buffer.clear();
+        // the background thread may have started fading out for a newer preset since, which wins
+        if (current == switched)
+            stage.compare_exchange_strong (current, fadingIn, std::memory_order_acq_rel);
+        return;
+    }
+
+    auto direction = current == fadingOut ? -gainStep : gainStep;
+    for (auto i = 0; i < numSamples; ++i)
+    {
+        gain = juce::jlimit (0.0f, 1.0f, gain + direction);
+        for (auto ch = 0; ch < numChannels; ++ch)
+            buffer.getWritePointer (ch)[i] *= static_cast<SampleType> (gain);
+    }
+
+    if (current == fadingOut && gain <= 0.0f)
+        stage.compare_exchange_strong (current, silent, std::memory_order_acq_rel);
+    else if (current == fadingIn && gain >= 1.0f)
+        stage.compare_exchange_strong (current, idle, std::memory_order_acq_rel);
+}
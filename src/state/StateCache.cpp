@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    StateCache.cpp
+
+  ==============================================================================
+*/
+
+#include "StateCache.h"
+
+using namespace juce;
+
+StateCache::StateCache (CaptureFn fn)
+    : captureFn (std::move (fn))
+{
+    jassert (captureFn != nullptr);
+}
+
+StateCache::~StateCache()
+{
+    stopTimer();
+}
+
+void StateCache::get (MemoryBlock& dest)
+{
+    if (!isTimerRunning())
+        startTimer (refreshIntervalMs);
+
+    auto current = generation.load (std::memory_order_relaxed);
+    {
+        const ScopedLock lock (cacheLock);
+        if (cachedGeneration == current)
+        {
+            dest = cached;
+            return;
+        }
+    }
+
+    // stale, so do it now. Grab the generation before capturing so anything that changes mid-capture leaves it dirty
+    capture (dest);
+    store (dest, current);
+}
+
+void StateCache::capture (MemoryBlock& dest)
+{
+    const ScopedLock lock (captureLock);
+    captureFn (dest);
+}
+
+void StateCache::store (const MemoryBlock& block, uint64 capturedGeneration)
+{
+    const ScopedLock lock (cacheLock);
+    if (capturedGeneration > cachedGeneration)
+    {
+        cached           = block;
+        cachedGeneration = capturedGeneration;
+    }
+}
+
+void StateCache::timerCallback()
+{
+    auto current = generation.load (std::memory_order_relaxed);
+    auto isStale = false;
+    {
+        const ScopedLock lock (cacheLock);
+        isStale = cachedGeneration != current;
+    }
+
+    // only capture once the state has stopped moving, so a parameter sweep doesn't keep the message thread busy
+    if (isStale && current == lastSeen)
+    {
+        MemoryBlock block;
+        capture (block);
+        store (block, current);
+    }
+    lastSeen = current;
+}
@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    StateCache.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "JuceHeader.h"
+
+/**
+ * Keeps the last serialised plugin state around, tagged with the generation it was captured at.
+ *
+ * Anything that changes the state calls markDirty(), which only bumps an atomic counter and is safe
+ * to call from the audio thread. get() hands back the cached blob if nothing has changed since it was
+ * captured. A timer on the message thread re-captures the state once the counter has settled, so by the
+ * time a host asks again there's usually a fresh blob waiting. The timer only starts once something has
+ * asked for the state, so a processor nobody saves, like one rendering offline, never runs it.
+ *
+ * Captures never overlap. The timer's and the host's (get() on whichever thread the host calls it from)
+ * take turns, so RNBO only ever sees one getPresetSync() at a time, like it did before there was a cache.
+ */
+struct StateCache : private juce::Timer
+{
+    using CaptureFn = std::function<void (juce::MemoryBlock&)>;
+
+    /** @param captureFn  serialises the current state, on the message thread or the thread calling get() */
+    explicit StateCache (CaptureFn captureFn);
+    ~StateCache() override;
+
+    void markDirty() noexcept { generation.fetch_add (1, std::memory_order_relaxed); }
+
+    /** Copies the current state into dest, capturing it first if the cached copy is stale */
+    void get (juce::MemoryBlock& dest);
+
+private:
+    /** how often the timer checks, a change has to sit still for one interval before it's captured */
+    static constexpr int refreshIntervalMs = 250;
+
+    CaptureFn                 captureFn;
+    std::atomic<juce::uint64> generation { 1 };
+    juce::CriticalSection     captureLock;
+    juce::CriticalSection     cacheLock;
+    juce::MemoryBlock         cached;
+    juce::uint64              cachedGeneration { 0 };
+    // message thread only
+    juce::uint64 lastSeen { 0 };
+
+    void timerCallback() override;
+    void capture (juce::MemoryBlock& dest);
+    void store (const juce::MemoryBlock& block, juce::uint64 capturedGeneration);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StateCache)
+};
@@ -0,0 +1,333 @@
+/*
+  ==============================================================================
+
+    StateFormat.cpp
+
+  ==============================================================================
+*/
+
+#include "StateFormat.h"
+#include "components/ParamIdentifiers.h"
+
+using namespace juce;
+
+namespace ChippoState
+{
+
+namespace
+{
+    enum Tag : uint8
+    {
+        null = 0,
+        falseValue,
+        trueValue,
+        integer,
+        integer64,
+        float32,
+        float64,
+        string,
+        array,
+        object,
+        // 0/1 arrays of floats, which is how RNBO stores sequences. Version 1 wrote integer ones like this too
+        bits,
+        integerBits
+    };
+
+    // a little over twice the longest sequence, so anything bigger is clearly not a sequence
+    static constexpr size_t maxBitsetLength = 128;
+
+    const char* const presetNameKey         = "presetName";
+    const char* const presetFileLocationKey = "presetFileLocation";
+
+    /** bits or integerBits if value can be packed, so it reads back as the same type of number, otherwise null */
+    Tag getBitArrayTag (const nlohmann::json& value)
+    {
+        if (value.empty() || value.size() > maxBitsetLength)
+            return null;
+
+        auto isFloat = value.front().is_number_float();
+        for (auto& v: value)
+        {
+            if (!v.is_number() || v.is_number_float() != isFloat)
+                return null;
+            auto d = v.get<double>();
+            if (d != 0.0 && d != 1.0)
+                return null;
+        }
+        return isFloat ? bits : integerBits;
+    }
+
+    void writeString (MemoryOutputStream& out, const std::string& s)
+    {
+        out.writeCompressedInt (static_cast<int> (s.size()));
+        out.write (s.data(), s.size());
+    }
+
+    std::string readString (MemoryInputStream& in)
+    {
+        auto        size = in.readCompressedInt();
+        std::string s (static_cast<size_t> (jmax (0, size)), '\0');
+        in.read (s.data(), size);
+        return s;
+    }
+
+    void writeValue (MemoryOutputStream& out, const nlohmann::json& value)
+    {
+        switch (value.type())
+        {
+            case nlohmann::json::value_t::boolean:
+                out.writeByte ((char) (value.get<bool>() ? trueValue : falseValue));
+                break;
+            case nlohmann::json::value_t::number_integer:
+            case nlohmann::json::value_t::number_unsigned:
+            {
+                auto i = value.get<int64>();
+                if (i >= std::numeric_limits<int>::min() && i <= std::numeric_limits<int>::max())
+                {
+                    out.writeByte ((char) integer);
+                    out.writeCompressedInt (static_cast<int> (i));
+                }
+                else
+                {
+                    out.writeByte ((char) integer64);
+                    out.writeInt64 (i);
+                }
+                break;
+            }
+            case nlohmann::json::value_t::number_float:
+            {
+                auto d = value.get<double>();
+                auto f = static_cast<float> (d);
+                if (static_cast<double> (f) == d)
+                {
+                    out.writeByte ((char) float32);
+                    out.writeFloat (f);
+                }
+                else
+                {
+                    out.writeByte ((char) float64);
+                    out.writeDouble (d);
+                }
+                break;
+            }
+            case nlohmann::json::value_t::string:
+                out.writeByte ((char) string);
+                writeString (out, value.get_ref<const std::string&>());
+                break;
+            case nlohmann::json::value_t::array:
+            {
+                auto bitArrayTag = getBitArrayTag (value);
+                if (bitArrayTag != null)
+                {
+                    out.writeByte ((char) bitArrayTag);
+                    out.writeCompressedInt (static_cast<int> (value.size()));
+                    uint64 word = 0;
+                    size_t i    = 0;
+                    for (auto& v: value)
+                    {
+                        if (v.get<double>() != 0.0)
+                            word |= (uint64) 1 << (i % 64);
+                        if (++i % 64 == 0)
+                        {
+                            out.writeInt64 ((int64) word);
+                            word = 0;
+                        }
+                    }
+                    if (i % 64 != 0)
+                        out.writeInt64 ((int64) word);
+                    break;
+                }
+                out.writeByte ((char) array);
+                out.writeCompressedInt (static_cast<int> (value.size()));
+                for (auto& v: value)
+                    writeValue (out, v);
+                break;
+            }
+            case nlohmann::json::value_t::object:
+                out.writeByte ((char) object);
+                out.writeCompressedInt (static_cast<int> (value.size()));
+                for (auto& item: value.items())
+                {
+                    writeString (out, item.key());
+                    writeValue (out, item.value());
+                }
+                break;
+            case nlohmann::json::value_t::null:
+            case nlohmann::json::value_t::binary:
+            case nlohmann::json::value_t::discarded:
+                out.writeByte ((char) null);
+                break;
+        }
+    }
+
+    bool readValue (MemoryInputStream& in, nlohmann::json& value)
+    {
+        if (in.isExhausted())
+            return false;
+
+        auto tag = static_cast<uint8> (in.readByte());
+        switch (tag)
+        {
+            case null:
+                value = nullptr;
+                return true;
+            case falseValue:
+                value = false;
+                return true;
+            case trueValue:
+                value = true;
+                return true;
+            case integer:
+                value = in.readCompressedInt();
+                return true;
+            case integer64:
+                value = static_cast<int64_t> (in.readInt64());
+                return true;
+            case float32:
+                value = static_cast<double> (in.readFloat());
+                return true;
+            case float64:
+                value = in.readDouble();
+                return true;
+            case string:
+                value = readString (in);
+                return true;
+            case bits:
+            case integerBits:
+            {
+                auto isFloat = tag == bits;
+                auto size    = static_cast<size_t> (jmax (0, in.readCompressedInt()));
+                if (size > maxBitsetLength)
+                    return false;
+                value       = nlohmann::json::array();
+                uint64 word = 0;
+                for (size_t i = 0; i < size; ++i)
+                {
+                    if (i % 64 == 0)
+                        word = (uint64) in.readInt64();
+                    auto isSet = ((word >> (i % 64)) & 1) != 0;
+                    if (isFloat)
+                        value.push_back (isSet ? 1.0 : 0.0);
+                    else
+                        value.push_back (isSet ? 1 : 0);
+                }
+                return true;
+            }
+            case array:
+            {
+                auto size = in.readCompressedInt();
+                value     = nlohmann::json::array();
+                for (auto i = 0; i < size; ++i)
+                {
+                    nlohmann::json v;
+                    if (!readValue (in, v))
+                        return false;
+                    value.push_back (std::move (v));
+                }
+                return true;
+            }
+            case object:
+            {
+                auto size = in.readCompressedInt();
+                value     = nlohmann::json::object();
+                for (auto i = 0; i < size; ++i)
+                {
+                    auto key = readString (in);
+                    if (!readValue (in, value[key]))
+                        return false;
+                }
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    String legacySequencerVisibilityKey (const Identifier& seq)
+    {
+        return sequencerVisIdt.toString() + seq.toString();
+    }
+
+    bool readLegacy (const void* data, size_t sizeInBytes, nlohmann::json& preset, Metadata& metadata)
+    {
+        auto begin = static_cast<const char*> (data);
+        preset     = nlohmann::json::parse (begin, begin + sizeInBytes, nullptr, false);
+        if (preset.is_discarded() || !preset.is_object())
+            return false;
+
+        // these come from files anyone can edit, so anything that isn't a string is dropped rather than trusted
+        if (preset.contains (presetNameKey))
+        {
+            auto& name = preset[presetNameKey];
+            if (name.is_string())
+                metadata.presetName = String::fromUTF8 (name.get_ref<const std::string&>().c_str());
+            preset.erase (presetNameKey);
+        }
+        if (preset.contains (presetFileLocationKey))
+        {
+            auto& location = preset[presetFileLocationKey];
+            if (location.is_string())
+                metadata.presetFileLocation = String::fromUTF8 (location.get_ref<const std::string&>().c_str());
+            preset.erase (presetFileLocationKey);
+        }
+
+        uint32 bit = 1;
+        for (auto& seq: SeqButtons::genIdts)
+        {
+            auto key = legacySequencerVisibilityKey (seq).toStdString();
+            if (preset.contains (key))
+            {
+                auto& value = preset[key];
+                auto  shown = value.is_string() ? value.get<std::string>() : value.dump();
+                if (shown == "1" || shown == "true")
+                    metadata.sequencerVisibility |= bit;
+                preset.erase (key);
+            }
+            bit <<= 1;
+        }
+        return true;
+    }
+} // namespace
+
+bool isBinaryState (const void* data, size_t sizeInBytes)
+{
+    return sizeInBytes >= sizeof (uint32) && ByteOrder::littleEndianInt (data) == magic;
+}
+
+void write (MemoryBlock& dest, const nlohmann::json& preset, const Metadata& metadata)
+{
+    dest.reset();
+    MemoryOutputStream out (dest, false);
+    out.writeInt ((int) magic);
+    out.writeShort ((short) currentVersion);
+
+    out.writeString (metadata.presetName);
+    out.writeString (metadata.presetFileLocation);
+    out.writeInt ((int) metadata.sequencerVisibility);
+
+    writeValue (out, preset);
+}
+
+bool read (const void* data, size_t sizeInBytes, nlohmann::json& preset, Metadata& metadata)
+{
+    if (!isBinaryState (data, sizeInBytes))
+        return readLegacy (data, sizeInBytes, preset, metadata);
+
+    MemoryInputStream in (data, sizeInBytes, false);
+    in.readInt(); // magic
+
+    auto version = static_cast<uint16> (in.readShort());
+    if (version > currentVersion)
+    {
+        jassertfalse; // state was saved by a newer build
+        return false;
+    }
+
+    metadata.presetName          = in.readString();
+    metadata.presetFileLocation  = in.readString();
+    metadata.sequencerVisibility = static_cast<uint32> (in.readInt());
+
+    return readValue (in, preset) && preset.is_object();
+}
+
+} // namespace ChippoState
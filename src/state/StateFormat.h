@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    StateFormat.h
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "JuceHeader.h"
+#include <json/json.hpp>
+
+/**
+ * Versioned binary plugin state.
+ *
+ * layout:  magic "CHPS" | version (uint16) | metadata | preset tree
+ *
+ * The preset tree is RNBO's preset written as tagged binary values rather than JSON text.
+ * Parameter entries collapse to a key and a float, and any list that only holds 0s and 1s
+ * (i.e. every sequence) is packed as a bitset, which reads back as the same type of number it was written as.
+ *
+ * Anything that doesn't start with the magic is treated as a legacy JSON state, which is what
+ * older sessions and .hop files contain.
+ */
+namespace ChippoState
+{
+
+static constexpr juce::uint32 magic          = 0x53504843; // "CHPS" little endian
+/** 2 added integer bitsets. Version 1 packed integer and float lists the same way, those read back as floats */
+static constexpr juce::uint16 currentVersion = 2;
+
+struct Metadata
+{
+    juce::String presetName;
+    juce::String presetFileLocation;
+    /** one bit per SeqButtons::genIdts entry, in that order */
+    juce::uint32 sequencerVisibility { 0 };
+};
+
+/** Writes the preset and metadata into dest, replacing anything already in there */
+void write (juce::MemoryBlock& dest, const nlohmann::json& preset, const Metadata& metadata);
+
+/**
+ * Reads either format. Legacy JSON metadata keys are moved out of the preset into metadata.
+ * Returns false if the data can't be read as either.
+ */
+bool read (const void* data, size_t sizeInBytes, nlohmann::json& preset, Metadata& metadata);
+
+bool isBinaryState (const void* data, size_t sizeInBytes);
+
+} // namespace ChippoState
@@ -0,0 +1,92 @@
+#include "JuceHeader.h"
+#include "../components/AssetFormat.h"
+
+/*
+    Build time tool, see assets/CMakeLists.txt. Decodes an image once, here, and writes it and smaller copies of
+    it, each half the size of the one before, as premultiplied ARGB pixels the editor can copy straight into an
+    Image. See AssetFormat.h for the layout.
+
+    ChippoAssets <image.png> <output folder> <levels>
+
+    writes <output folder>/<name>.pix, then <name>_mip1.pix to <name>_mip<levels>.pix
+*/
+
+using namespace juce;
+
+static int fail (const String& message)
+{
+    std::cerr << message << std::endl;
+    return 1;
+}
+
+static bool write (const Image& image, const File& output)
+{
+    const Image::BitmapData bitmap (image, Image::BitmapData::readOnly);
+
+    // rows in the order AssetFormat defines, whatever this platform's pixel layout is
+    MemoryBlock pixels (static_cast<size_t> (image.getWidth() * image.getHeight()) * AssetFormat::bytesPerPixel);
+    auto        dest = static_cast<uint8*> (pixels.getData());
+    for (auto y = 0; y < image.getHeight(); ++y)
+    {
+        for (auto x = 0; x < image.getWidth(); ++x)
+        {
+            AssetFormat::writePixel (dest, *reinterpret_cast<const PixelARGB*> (bitmap.getPixelPointer (x, y)));
+            dest += AssetFormat::bytesPerPixel;
+        }
+    }
+
+    MemoryOutputStream compressed;
+    {
+        GZIPCompressorOutputStream zlib (compressed, 9);
+        zlib.write (pixels.getData(), pixels.getSize());
+    }
+
+    // tiny images can come out bigger, store those as they are
+    auto storeRaw = compressed.getDataSize() >= pixels.getSize();
+
+    output.deleteFile();
+    FileOutputStream stream (output);
+    if (!stream.openedOk())
+        return false;
+
+    stream.write (AssetFormat::magic, 4);
+    stream.writeInt (image.getWidth());
+    stream.writeInt (image.getHeight());
+    stream.writeInt (storeRaw ? AssetFormat::stored : AssetFormat::deflated);
+    if (storeRaw)
+        return stream.write (pixels.getData(), pixels.getSize());
+    return stream.write (compressed.getData(), compressed.getDataSize());
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc != 4)
+        return fail ("usage: ChippoAssets <image.png> <output folder> <levels>");
+
+    auto input     = File::getCurrentWorkingDirectory().getChildFile (String (CharPointer_UTF8 (argv[1])));
+    auto outputDir = File::getCurrentWorkingDirectory().getChildFile (String (CharPointer_UTF8 (argv[2])));
+    auto numLevels = String (argv[3]).getIntValue();
+
+    auto image = ImageFileFormat::loadFrom (input);
+    if (!image.isValid())
+        return fail ("couldn't load " + input.getFullPathName());
+
+    // always work in premultiplied ARGB, a PNG without transparency loads as RGB
+    image = image.convertedToFormat (Image::ARGB);
+
+    if (!outputDir.createDirectory())
+        return fail ("couldn't create " + outputDir.getFullPathName());
+
+    auto name = input.getFileNameWithoutExtension();
+    for (auto level = 0; level <= numLevels; ++level)
+    {
+        // halve the last level rather than the original every time, it's much closer to averaging each 2x2 block
+        if (level > 0)
+            image = image.rescaled (jmax (1, image.getWidth() / 2), jmax (1, image.getHeight() / 2), Graphics::highResamplingQuality);
+
+        auto output = outputDir.getChildFile (name + (level > 0 ? "_mip" + String (level) : String()) + AssetFormat::extension);
+        if (!write (image, output))
+            return fail ("couldn't write " + output.getFullPathName());
+    }
+    return 0;
+}
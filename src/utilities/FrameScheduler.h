@@ -0,0 +1,173 @@
+/*
+ ==============================================================================
+
+    Frame Scheduler
+
+ ==============================================================================
+ */
+
+#pragma once
+#include "JuceHeader.h"
+
+namespace nlt
+{
+
+using namespace juce;
+
+/**
+ * One clock for everything the UI does on a timer, so it all happens in a single pass per display frame.
+ *
+ * While an editor is on screen the clock is its display's vertical blank, through a VBlankSource. When
+ * there isn't one, or it has stopped firing, a 60 Hz timer stands in. Tasks run on the frame nearest to when
+ * their interval is up, so slower tasks land on the same frames as everything else.
+ *
+ * Tasks that only update the UI can ask to be suspended while no editor is showing, e.g. when it's closed
+ * or minimised. They catch up in one go on the first frame it's back.
+ *
+ * Message thread only. Share it with a SharedResourcePointer.
+ */
+struct FrameScheduler : private Timer
+{
+    struct Task
+    {
+        virtual ~Task() = default;
+
+        virtual void handleFrame() = 0;
+
+    protected:
+        /** 0 runs the task on every frame */
+        double intervalMs { 0.0 };
+        /** skip this task while no VBlankSource's component is showing */
+        bool suspendWhileHidden { false };
+
+    private:
+        friend struct FrameScheduler;
+        double lastRunMs { 0.0 };
+    };
+
+    /** Drives the scheduler from the vertical blank of the display a component is on */
+    struct VBlankSource
+    {
+        explicit VBlankSource (Component* c)
+            : component (c)
+            , attachment (c, [this] { scheduler->vblank(); })
+        {
+            scheduler->sources.push_back (this);
+        }
+
+        ~VBlankSource()
+        {
+            auto& sources = scheduler->sources;
+            sources.erase (std::remove (sources.begin(), sources.end(), this), sources.end());
+        }
+
+    private:
+        friend struct FrameScheduler;
+        Component*                            component;
+        SharedResourcePointer<FrameScheduler> scheduler;
+        VBlankAttachment                      attachment;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VBlankSource)
+    };
+
+    FrameScheduler() = default;
+    ~FrameScheduler() override { stopTimer(); }
+
+    void add (Task* task)
+    {
+        JUCE_ASSERT_MESSAGE_THREAD
+        if (std::find (tasks.begin(), tasks.end(), task) == tasks.end())
+            tasks.push_back (task);
+        if (!isTimerRunning())
+            startTimerHz (fallbackHz);
+    }
+
+    void remove (Task* task)
+    {
+        JUCE_ASSERT_MESSAGE_THREAD
+        // removing can happen from inside a task, so just clear the slot and tidy up after the frame
+        auto found = std::find (tasks.begin(), tasks.end(), task);
+        if (found != tasks.end())
+            *found = nullptr;
+        if (!inFrame)
+            compact();
+    }
+
+    bool contains (const Task* task) const { return std::find (tasks.begin(), tasks.end(), task) != tasks.end(); }
+
+private:
+    static constexpr int    fallbackHz = 60;
+    /** how long without a vertical blank before the timer takes over */
+    static constexpr double vblankTimeoutMs = 100.0;
+
+    std::vector<Task*>         tasks;
+    std::vector<VBlankSource*> sources;
+    double                     lastFrameMs { 0.0 };
+    double                     lastVBlankMs { 0.0 };
+    double                     frameIntervalMs { 1000.0 / fallbackHz };
+    bool                       inFrame { false };
+
+    void vblank()
+    {
+        auto now = Time::getMillisecondCounterHiRes();
+        if (now - lastVBlankMs < vblankTimeoutMs)
+            frameIntervalMs += 0.1 * ((now - lastVBlankMs) - frameIntervalMs);
+        lastVBlankMs = now;
+        frame (now);
+    }
+
+    void timerCallback() override
+    {
+        if (tasks.empty())
+        {
+            stopTimer();
+            return;
+        }
+
+        auto now = Time::getMillisecondCounterHiRes();
+        if (now - lastVBlankMs >= vblankTimeoutMs)
+        {
+            frameIntervalMs = 1000.0 / fallbackHz;
+            frame (now);
+        }
+    }
+
+    void frame (double now)
+    {
+        // with several editors open, each one's vertical blank lands here
+        auto slack = 0.5 * frameIntervalMs;
+        if (now - lastFrameMs < slack)
+            return;
+        lastFrameMs = now;
+
+        auto showing = isAnySourceShowing();
+
+        const ScopedValueSetter<bool> scope (inFrame, true);
+        // by index, tasks can be added while this runs
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            auto* task = tasks[i];
+            if (task == nullptr || (task->suspendWhileHidden && !showing))
+                continue;
+
+            if (now - task->lastRunMs >= task->intervalMs - slack)
+            {
+                task->lastRunMs = now;
+                task->handleFrame();
+            }
+        }
+        compact();
+    }
+
+    bool isAnySourceShowing() const
+    {
+        // isShowing() is false for a minimised window too
+        return std::any_of (sources.begin(), sources.end(), [] (const VBlankSource* s) { return s->component->isShowing(); });
+    }
+
+    void compact() { tasks.erase (std::remove (tasks.begin(), tasks.end(), nullptr), tasks.end()); }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrameScheduler)
+};
+
+} // namespace nlt
@@ -10,6 +10,7 @@
 #pragma once
 #include "JuceHeader.h"
 #include "NLT_FWD.h"
+#include "FrameScheduler.h"
 
 namespace nlt
 {
@@ -17,9 +18,10 @@ namespace nlt
 using namespace juce;
 /**
  *  Executes a set function on a timed callback.
- *  Cleaner than inheriting from Timer
+ *  Cleaner than inheriting from Timer, and runs on the FrameScheduler's clock so it lines up with the
+ *  display and every other timed action.
  */
-struct TimerAction : private Timer
+struct TimerAction : private FrameScheduler::Task
 {
     /**
      * @tparam Fn           void() function
@@ -33,16 +35,14 @@ struct TimerAction : private Timer
     {
         jassert (timerActionFn != nullptr); // need a function here
         jassert (timerHz > 0.0f);
-        setTimerHz (timerHz);
-        if (start)
-            startTimer (timerMs);
+        setTimerHz (timerHz, start);
     }
 
-    TimerAction() = default;
+    TimerAction() { intervalMs = 1000.0; }
 
-    ~TimerAction() override = default;
+    ~TimerAction() override { stop(); }
 
-    void timerCallback() override { timerActionFn(); }
+    void handleFrame() override { timerActionFn(); }
 
     void setTimerHz (float timerHz, bool shouldStartTimer = true)
     {
@@ -50,21 +50,26 @@ struct TimerAction : private Timer
         setTimerMs (1000.0f / timerHz, shouldStartTimer);
     }
 
+    /** 0 runs the action on every display frame */
     void setTimerMs (int ms, bool shouldStartTimer = true)
     {
-        timerMs = ms;
+        intervalMs = static_cast<double> (ms);
         if (shouldStartTimer)
-            startTimer (timerMs);
+            scheduler->add (this);
     }
 
     void start (bool beginActionImmediately = false)
     {
-        if (!isTimerRunning())
-            startTimer (timerMs);
+        scheduler->add (this);
         if (beginActionImmediately)
             timerActionFn();
     }
-    void stop() { stopTimer(); }
+    void stop() { scheduler->remove (this); }
+
+    bool isRunning() const { return scheduler->contains (this); }
+
+    /** For actions that only update the UI, see FrameScheduler */
+    void setSuspendedWhileHidden (bool shouldSuspend) { suspendWhileHidden = shouldSuspend; }
 
     template <typename Fn>
     void setAction (Fn&& fn, float timerHz = 0.0f, bool startAction = true)
@@ -76,8 +81,8 @@ struct TimerAction : private Timer
     }
 
 private:
-    std::function<void()> timerActionFn { nullptr };
-    int                   timerMs { 1000 };
+    std::function<void()>                 timerActionFn { nullptr };
+    SharedResourcePointer<FrameScheduler> scheduler;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimerAction)
 };
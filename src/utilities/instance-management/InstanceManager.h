@@ -9,13 +9,21 @@
 
 #pragma once
 #include "JuceHeader.h"
-#include "../containers/VectorTools.h"
 
 namespace nlt
 {
 
 /**
  * This will hold pointers to every instance of a specific class. Should be used as a base class for whatever it is that needs doing
+ *
+ * Every instance remembers its own slot, so adding and removing are O(1) whatever the number of instances. forEachInstance
+ * only holds the lock while it steps to the next slot, not while it calls into the instance, so instances can be added and removed
+ * meanwhile, from the callback too. Slots removed during a pass are left empty and tidied up once the last pass is done.
+ *
+ * Each pass pins the instance it's calling into. Removing a pinned instance from another thread waits until the call returns,
+ * so once removeInstance() is done no pass can reach it and it's safe to destroy. Removing it from inside the call doesn't wait.
+ * ManagedInstance removes itself in its own destructor, after the subclass is gone, so subclasses a pass calls into should call
+ * removeFromInstanceManager() first thing in their destructor.
  * @tparam InstanceClass
  */
 template <typename ManagedInstance, typename LockType = juce::SpinLock>
@@ -30,29 +38,123 @@ struct InstanceManager
     void addInstance (ManagedInstance* callback)
     {
         ScopeLock lock (instancesLock);
-        auto      added = nlt::Vectors::addIfNotPresent (instances, callback);
-        juce::ignoreUnused (added);
+        if (callback->managerSlot != notManaged)
+            return;
+
+        callback->managerSlot = instances.size();
+        instances.push_back (callback);
     }
 
     void removeInstance (ManagedInstance* callback)
     {
         ScopeLock lock (instancesLock);
-        auto      removed = nlt::Vectors::remove (instances, callback);
-        juce::ignoreUnused (removed);
+        auto      slot = callback->managerSlot;
+        if (slot == notManaged)
+            return;
+
+        if (passes != nullptr)
+        {
+            // a pass is stepping through by index, moving things around under it would skip an instance
+            instances[slot] = nullptr;
+            ++numEmptySlots;
+        }
+        else
+        {
+            instances[slot]              = instances.back();
+            instances[slot]->managerSlot = slot;
+            instances.pop_back();
+        }
+        callback->managerSlot = notManaged;
+
+        while (isInUseElsewhere (callback))
+        {
+            const typename LockType::ScopedUnlockType unlock (instancesLock);
+            juce::Thread::yield();
+        }
     }
 
     long getNumInstances() const
     {
         ScopeLock lock (instancesLock);
-        return static_cast<long> (instances.size());
+        return static_cast<long> (instances.size() - numEmptySlots);
     }
 
 protected:
     LockType                      instancesLock;
     std::vector<ManagedInstance*> instances;
 
+    /**
+     * Calls the function on every instance. Instances added during the pass may or may not be visited, instances removed
+     * before they're reached won't be.
+     */
+    template <typename Function>
+    void forEachInstance (Function&& function)
+    {
+        Pass pass;
+        {
+            ScopeLock lock (instancesLock);
+            pass.next = passes;
+            passes    = &pass;
+        }
+
+        for (size_t i = 0;; ++i)
+        {
+            {
+                ScopeLock lock (instancesLock);
+                if (i >= instances.size())
+                {
+                    pass.current = nullptr;
+                    break;
+                }
+                pass.current = instances[i];
+            }
+            if (pass.current != nullptr)
+                function (*pass.current);
+        }
+
+        ScopeLock lock (instancesLock);
+        auto**    link = &passes;
+        while (*link != &pass)
+            link = &(*link)->next;
+        *link = pass.next;
+
+        if (passes == nullptr && numEmptySlots > 0)
+            compact();
+    }
+
     std::unique_ptr<ScopeLock> getInstancesLock() { return std::make_unique<ScopeLock> (instancesLock); }
 
+private:
+    static constexpr size_t notManaged = std::numeric_limits<size_t>::max();
+
+    /** a forEachInstance in progress, and the instance it's calling into */
+    struct Pass
+    {
+        ManagedInstance*       current { nullptr };
+        juce::Thread::ThreadID thread { juce::Thread::getCurrentThreadId() };
+        Pass*                  next { nullptr };
+    };
+
+    // the passes in progress, each lives on its caller's stack
+    Pass*  passes { nullptr };
+    size_t numEmptySlots { 0 };
+
+    bool isInUseElsewhere (ManagedInstance* instance) const
+    {
+        for (auto* pass = passes; pass != nullptr; pass = pass->next)
+            if (pass->current == instance && pass->thread != juce::Thread::getCurrentThreadId())
+                return true;
+        return false;
+    }
+
+    void compact()
+    {
+        instances.erase (std::remove (instances.begin(), instances.end(), nullptr), instances.end());
+        for (size_t i = 0; i < instances.size(); ++i)
+            instances[i]->managerSlot = i;
+        numEmptySlots = 0;
+    }
+
     JUCE_LEAK_DETECTOR (InstanceManager)
 };
 
@@ -82,9 +184,16 @@ protected:
 
     void removeFromInstanceManager() { instanceManager->removeInstance (static_cast<SubClass*> (this)); }
 
+    InstanceManager& getInstanceManager() noexcept { return *instanceManager; }
+
 private:
+    template <typename, typename>
+    friend struct nlt::InstanceManager;
+
     juce::SharedResourcePointer<InstanceManager> instanceManager;
     bool                                         removesSelf { true };
+    /** where this is in the manager's list, kept up to date by the manager */
+    size_t managerSlot { std::numeric_limits<size_t>::max() };
 
     JUCE_LEAK_DETECTOR (ManagedInstance)
 };
@@ -16,14 +16,24 @@ namespace nlt
 using namespace juce;
 
 /**
- * Inherit from this to have a global manager call an action on all instances. Implement handleGlobalTimedAction()
- * and set the ActionRate in the template arg.
+ * Inherit from this to have a global manager call an action on instances that have changed. Implement
+ * handleGlobalTimedAction(), call markDirty() whenever there's something for it to do and set the ActionRate
+ * in the template arg.
  *
  * @code
+ * void parameterValueChanged (int, float newValue) override
+ * {
+ *      value = newValue;
+ *      markDirty();
+ * }
+ *
  * void handleGlobalTimedAction()
  * {
- *      // some action that will be called on all instances at UpdateRateHz rate
+ *      // called on the message thread at the next tick after markDirty(), at most once per tick
  * }
+ * If the action only updates the UI, add `static constexpr bool isUIOnly = true;` to the subclass and it
+ * won't run while no editor is showing.
+ *
  * @tparam SubClass
  * @tparam ActionRateHz
  * @tparam ActionRateDenominator for rates slower than one Hz
@@ -31,14 +41,40 @@ using namespace juce;
 template <typename SubClass, int ActionRateHz, int ActionRateDenominator>
 struct TimedActionInstance;
 
+template <typename SubClass, typename = void>
+struct IsUIOnly : std::false_type
+{
+};
+
+template <typename SubClass>
+struct IsUIOnly<SubClass, std::void_t<decltype (SubClass::isUIOnly)>> : std::bool_constant<SubClass::isUIOnly>
+{
+};
+
 template <typename SubClass, int ActionRateHz, int ActionRateDenominator>
 struct TimedActionInstanceManager : public InstanceManager<TimedActionInstance<SubClass, ActionRateHz, ActionRateDenominator>>
 {
+    using Instance = TimedActionInstance<SubClass, ActionRateHz, ActionRateDenominator>;
+
     TimedActionInstanceManager();
     ~TimedActionInstanceManager() override = default;
 
 private:
+    friend Instance;
+
+    /**
+     * Instances waiting for the next tick, as a lock free stack linked through Instance::nextDirty.
+     * Any thread can push, only the message thread takes them off, and it always takes the lot.
+     */
+    std::atomic<Instance*> dirtyHead { nullptr };
+    /** what's left of the batch being handled, so an instance deleted by another's action can be taken out */
+    Instance*        visiting { nullptr };
     nlt::TimerAction timerAction;
+
+    void pushDirty (Instance* instance) noexcept;
+    void removeDirty (Instance* instance) noexcept;
+    void handleDirty();
+
     JUCE_LEAK_DETECTOR (TimedActionInstanceManager)
 };
 
@@ -53,11 +89,29 @@ template <typename SubClass, int ActionRateHz, int ActionRateDenominator = 1>
 struct TimedActionInstance : public ManagedInstance<TimedActionInstance<SubClass, ActionRateHz, ActionRateDenominator>,
                                                     TimedActionInstanceManager<SubClass, ActionRateHz, ActionRateDenominator>>
 {
-    TimedActionInstance()                   = default;
-    virtual ~TimedActionInstance() override = default;
+    TimedActionInstance() = default;
+
+    // deleting an instance has to happen on the message thread, and after whatever calls markDirty() has stopped
+    ~TimedActionInstance() override
+    {
+        if (queued.load (std::memory_order_acquire))
+            this->getInstanceManager().removeDirty (this);
+    }
+
+protected:
+    /** Has handleGlobalTimedAction() called at the next tick. Lock free, safe to call from any thread */
+    void markDirty() noexcept
+    {
+        if (!queued.exchange (true, std::memory_order_acq_rel))
+            this->getInstanceManager().pushDirty (this);
+    }
 
 private:
-    friend class TimedActionInstanceManager<SubClass, ActionRateHz, ActionRateDenominator>;
+    friend struct TimedActionInstanceManager<SubClass, ActionRateHz, ActionRateDenominator>;
+
+    std::atomic<bool>    queued { false };
+    TimedActionInstance* nextDirty { nullptr };
+
     void handleGlobalTimedActionInternal() { static_cast<SubClass*> (this)->handleGlobalTimedAction(); }
     JUCE_LEAK_DETECTOR (TimedActionInstance)
 };
@@ -66,15 +120,59 @@ template <typename SubClass, int ActionRateHz, int ActionRateDenominator>
 TimedActionInstanceManager<SubClass, ActionRateHz, ActionRateDenominator>::TimedActionInstanceManager()
 {
     static_assert (ActionRateHz > 0 && ActionRateDenominator > 0, "should have a positive rate and denominator!");
-    timerAction.setAction (
-        [this]()
+    timerAction.setSuspendedWhileHidden (IsUIOnly<SubClass>::value);
+    timerAction.setAction ([this]() { handleDirty(); },
+                           static_cast<float> (ActionRateHz) / static_cast<float> (ActionRateDenominator));
+}
+
+template <typename SubClass, int ActionRateHz, int ActionRateDenominator>
+void TimedActionInstanceManager<SubClass, ActionRateHz, ActionRateDenominator>::pushDirty (Instance* instance) noexcept
+{
+    auto* head = dirtyHead.load (std::memory_order_relaxed);
+    do
+    {
+        instance->nextDirty = head;
+    } while (!dirtyHead.compare_exchange_weak (head, instance, std::memory_order_release, std::memory_order_relaxed));
+}
+
+template <typename SubClass, int ActionRateHz, int ActionRateDenominator>
+void TimedActionInstanceManager<SubClass, ActionRateHz, ActionRateDenominator>::removeDirty (Instance* instance) noexcept
+{
+    for (auto** link = &visiting; *link != nullptr; link = &(*link)->nextDirty)
+    {
+        if (*link == instance)
         {
-            auto lock = this->getInstancesLock();
-            ignoreUnused (lock);
-            for (auto& instance: this->instances)
-                instance->handleGlobalTimedActionInternal();
-        },
-        static_cast<float> (ActionRateHz) / static_cast<float> (ActionRateDenominator));
+            *link = instance->nextDirty;
+            return;
+        }
+    }
+
+    // take the whole stack and put back everything else, anything pushed meanwhile just goes on top
+    auto* dirty = dirtyHead.exchange (nullptr, std::memory_order_acquire);
+    while (dirty != nullptr)
+    {
+        auto* next = dirty->nextDirty;
+        if (dirty != instance)
+            pushDirty (dirty);
+        dirty = next;
+    }
+}
+
+template <typename SubClass, int ActionRateHz, int ActionRateDenominator>
+void TimedActionInstanceManager<SubClass, ActionRateHz, ActionRateDenominator>::handleDirty()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    visiting = dirtyHead.exchange (nullptr, std::memory_order_acquire);
+    while (visiting != nullptr)
+    {
+        auto* instance = visiting;
+        visiting       = instance->nextDirty;
+
+        // cleared first, so a change made while the action runs gets picked up next tick
+        instance->queued.store (false, std::memory_order_release);
+        instance->handleGlobalTimedActionInternal();
+    }
 }
 
 } // namespace nlt
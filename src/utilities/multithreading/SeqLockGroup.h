@@ -0,0 +1,117 @@
+/*
+ ==============================================================================
+
+    SeqLock Group
+
+ ==============================================================================
+ */
+
+#pragma once
+#include "JuceHeader.h"
+
+namespace nlt
+{
+
+using namespace juce;
+
+/**
+ * A fixed size group of values that's always read as a whole, e.g. the stages of an envelope.
+ *
+ * Writers bump a sequence number before and after changing anything, and a reader copies the values out and
+ * checks the number didn't move while it did. Readers never take a lock or block a writer. If a writer keeps
+ * getting in the way, read gives up after a few attempts rather than spinning, and the caller tries again later.
+ *
+ * Writers on different threads take turns, writes should be a handful of stores. Use a ScopedWrite to change
+ * several values as one update.
+ */
+template <typename Type>
+struct SeqLockGroup
+{
+    explicit SeqLockGroup (size_t numValues)
+        : values (numValues)
+    {
+    }
+
+    struct ScopedWrite
+    {
+        explicit ScopedWrite (SeqLockGroup& g) noexcept
+            : group (g)
+        {
+            group.beginWrite();
+        }
+
+        ~ScopedWrite() noexcept { group.endWrite(); }
+
+        void set (size_t index, Type value) noexcept { group.values[index].store (value, std::memory_order_relaxed); }
+
+    private:
+        SeqLockGroup& group;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedWrite)
+    };
+
+    void set (size_t index, Type value) noexcept
+    {
+        ScopedWrite write (*this);
+        write.set (index, value);
+    }
+
+    size_t size() const noexcept { return values.size(); }
+
+    /** Goes up by one with every finished write */
+    uint32 getVersion() const noexcept { return sequence.load (std::memory_order_acquire) / 2; }
+
+    /**
+     * Copies every value into copy, which should already be the right size. Returns false, leaving copy in an unknown
+     * state, if it couldn't get a consistent copy within maxAttempts.
+     *
+     * @param version  if not null, set to the version that was read
+     */
+    bool read (std::vector<Type>& copy, uint32* version = nullptr, int maxAttempts = 4) const noexcept
+    {
+        jassert (copy.size() == values.size());
+
+        for (auto attempt = 0; attempt < maxAttempts; ++attempt)
+        {
+            auto before = sequence.load (std::memory_order_acquire);
+            if (before & 1u)
+                continue;
+
+            for (size_t i = 0; i < values.size(); ++i)
+                copy[i] = values[i].load (std::memory_order_relaxed);
+
+            std::atomic_thread_fence (std::memory_order_acquire);
+            if (sequence.load (std::memory_order_relaxed) == before)
+            {
+                if (version != nullptr)
+                    *version = before / 2;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::vector<std::atomic<Type>> values;
+    // odd while a write is in progress
+    std::atomic<uint32> sequence { 0 };
+
+    void beginWrite() noexcept
+    {
+        auto current = sequence.load (std::memory_order_relaxed);
+        for (;;)
+        {
+            if (current & 1u)
+                current = sequence.load (std::memory_order_relaxed);
+            else if (sequence.compare_exchange_weak (current, current + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                break;
+        }
+        std::atomic_thread_fence (std::memory_order_release);
+    }
+
+    void endWrite() noexcept { sequence.fetch_add (1, std::memory_order_release); }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SeqLockGroup)
+};
+
+} // namespace nlt
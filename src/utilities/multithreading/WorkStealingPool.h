@@ -0,0 +1,167 @@
+/*
+ ==============================================================================
+
+    Work Stealing Pool
+
+ ==============================================================================
+ */
+
+#pragma once
+#include "JuceHeader.h"
+#include "../NLT_FWD.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace nlt
+{
+
+using namespace juce;
+
+/**
+ * Fixed size pool where every worker has its own job queue. Workers take jobs from the back of their
+ * own queue and steal from the front of everybody else's when they run dry, so long jobs don't leave
+ * cores idle while short ones pile up behind them.
+ *
+ * Jobs are given the index of the worker running them, which makes it easy to keep one expensive
+ * context per worker (e.g. one processor per thread) without any locking.
+ */
+struct WorkStealingPool
+{
+    using Job = std::function<void (int workerIndex)>;
+
+    explicit WorkStealingPool (int numWorkersToUse = SystemStats::getNumCpus())
+        : queues (static_cast<size_t> (jmax (1, numWorkersToUse)))
+    {
+        for (size_t i = 0; i < queues.size(); ++i)
+            workers.emplace_back ([this, i]() { run (static_cast<int> (i)); });
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock (sleepLock);
+            shouldExit = true;
+        }
+        wakeUp.notify_all();
+        for (auto& w: workers)
+            w.join();
+    }
+
+    int getNumWorkers() const { return static_cast<int> (workers.size()); }
+
+    /** Adds a job to the next worker's queue, round robin. Any idle worker may steal it */
+    template <typename Fn>
+    void addJob (Fn&& job)
+    {
+        // count it before it's visible to the workers, so it can't finish before it's been counted
+        {
+            std::lock_guard<std::mutex> lock (sleepLock);
+            ++numPending;
+        }
+        auto& queue = queues[nextQueue++ % queues.size()];
+        {
+            std::lock_guard<std::mutex> lock (queue.lock);
+            queue.jobs.emplace_back (NLT_FWD (job));
+        }
+        {
+            // taking the lock here means a worker can't be between checking the queues and going to sleep
+            std::lock_guard<std::mutex> lock (sleepLock);
+        }
+        wakeUp.notify_one();
+    }
+
+    /** Blocks until every job that has been added so far has finished */
+    void waitForAll()
+    {
+        std::unique_lock<std::mutex> lock (sleepLock);
+        allDone.wait (lock, [this]() { return numPending == 0; });
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex      lock;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<Queue>       queues;
+    std::vector<std::thread> workers;
+    size_t                   nextQueue { 0 };
+
+    std::mutex              sleepLock;
+    std::condition_variable wakeUp;
+    std::condition_variable allDone;
+    size_t                  numPending { 0 };
+    bool                    shouldExit { false };
+
+    bool popOwn (int workerIndex, Job& job)
+    {
+        auto&                       queue = queues[static_cast<size_t> (workerIndex)];
+        std::lock_guard<std::mutex> lock (queue.lock);
+        if (queue.jobs.empty())
+            return false;
+        job = std::move (queue.jobs.back());
+        queue.jobs.pop_back();
+        return true;
+    }
+
+    bool steal (int workerIndex, Job& job)
+    {
+        for (size_t offset = 1; offset < queues.size(); ++offset)
+        {
+            auto&                       victim = queues[(static_cast<size_t> (workerIndex) + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock (victim.lock);
+            if (!victim.jobs.empty())
+            {
+                job = std::move (victim.jobs.front());
+                victim.jobs.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run (int workerIndex)
+    {
+        for (;;)
+        {
+            Job job;
+            if (popOwn (workerIndex, job) || steal (workerIndex, job))
+            {
+                job (workerIndex);
+
+                std::lock_guard<std::mutex> lock (sleepLock);
+                if (--numPending == 0)
+                    allDone.notify_all();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock (sleepLock);
+            if (shouldExit)
+                return;
+
+            // a job may have been queued after we looked, go look again rather than sleeping on it
+            if (hasQueuedJobs())
+                continue;
+
+            wakeUp.wait (lock);
+        }
+    }
+
+    bool hasQueuedJobs()
+    {
+        for (auto& q: queues)
+        {
+            std::lock_guard<std::mutex> lock (q.lock);
+            if (!q.jobs.empty())
+                return true;
+        }
+        return false;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkStealingPool)
+};
+
+} // namespace nlt